@@ -1 +1,2 @@
-gcc -g -o cdraw main.c quadtree.c window.c surface.c -lX11 -lm
+gcc -g -O2 -fno-trapping-math -o cdraw main.c quadtree.c window.c surface.c random.c camera.c snapshot.c layer.c raster.c graphics.c memtrack.c resolution.c -lX11 -lm
+gcc -g -O2 -fno-trapping-math -o spatialbench spatialbench.c spatial.c grid.c kdtree.c quadtree.c window.c surface.c random.c camera.c layer.c memtrack.c -lX11 -lm
@@ -0,0 +1,60 @@
+#include "camera.h"
+
+void initCamera(Camera* cam, vec2 center, float zoom, int viewWidth, int viewHeight)
+{
+    cam->center = center;
+    cam->zoom = zoom;
+    cam->viewWidth = viewWidth;
+    cam->viewHeight = viewHeight;
+}
+
+vec2 worldToScreen(const Camera* cam, vec2 p)
+{
+    vec2 s = {(p.x - cam->center.x) * cam->zoom + cam->viewWidth * 0.5f,
+              (p.y - cam->center.y) * cam->zoom + cam->viewHeight * 0.5f};
+    return s;
+}
+
+vec2 screenToWorld(const Camera* cam, vec2 p)
+{
+    vec2 w = {(p.x - cam->viewWidth * 0.5f) / cam->zoom + cam->center.x,
+              (p.y - cam->viewHeight * 0.5f) / cam->zoom + cam->center.y};
+    return w;
+}
+
+void cameraViewBounds(const Camera* cam, vec2* min, vec2* max)
+{
+    vec2 topLeft = {0.0f, 0.0f};
+    vec2 bottomRight = {(float)cam->viewWidth, (float)cam->viewHeight};
+    *min = screenToWorld(cam, topLeft);
+    *max = screenToWorld(cam, bottomRight);
+}
+
+void panCamera(Camera* cam, float dxPixels, float dyPixels)
+{
+    cam->center.x -= dxPixels / cam->zoom;
+    cam->center.y -= dyPixels / cam->zoom;
+}
+
+void zoomCamera(Camera* cam, float factor, vec2 anchor)
+{
+    float zoom = cam->zoom * factor;
+    if (zoom < CAMERA_MIN_ZOOM) zoom = CAMERA_MIN_ZOOM;
+    if (zoom > CAMERA_MAX_ZOOM) zoom = CAMERA_MAX_ZOOM;
+
+    // Keep the world point under the anchor where it is on screen
+    vec2 before = screenToWorld(cam, anchor);
+    cam->zoom = zoom;
+    vec2 after = screenToWorld(cam, anchor);
+    cam->center.x += before.x - after.x;
+    cam->center.y += before.y - after.y;
+}
+
+Camera resizeCameraView(const Camera* cam, int viewWidth, int viewHeight)
+{
+    Camera resized = *cam;
+    resized.zoom = cam->viewWidth > 0 ? cam->zoom * (float)viewWidth / (float)cam->viewWidth : cam->zoom;
+    resized.viewWidth = viewWidth;
+    resized.viewHeight = viewHeight;
+    return resized;
+}
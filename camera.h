@@ -0,0 +1,35 @@
+#ifndef CAMERA_H
+#define CAMERA_H
+
+#include "vec2.h"
+
+#define CAMERA_MIN_ZOOM 0.25f
+#define CAMERA_MAX_ZOOM 100000.0f
+#define CAMERA_ZOOM_STEP 1.25f
+#define CAMERA_PAN_STEP  50.0f
+
+// 2D view: world point `center` sits in the middle of a viewWidth x viewHeight viewport,
+// scaled by `zoom` screen pixels per world unit.
+typedef struct Camera
+{
+    vec2 center;
+    float zoom;
+    int viewWidth;
+    int viewHeight;
+} Camera;
+
+void initCamera(Camera* cam, vec2 center, float zoom, int viewWidth, int viewHeight);
+
+vec2 worldToScreen(const Camera* cam, vec2 p);
+vec2 screenToWorld(const Camera* cam, vec2 p);
+
+// World-space rectangle currently covered by the viewport
+void cameraViewBounds(const Camera* cam, vec2* min, vec2* max);
+
+void panCamera(Camera* cam, float dxPixels, float dyPixels);
+// Zooms by factor while keeping the world point under `anchor` (screen space) fixed
+void zoomCamera(Camera* cam, float factor, vec2 anchor);
+// The same view fitted to a viewport of another size; zoom scales with the width
+Camera resizeCameraView(const Camera* cam, int viewWidth, int viewHeight);
+
+#endif //CAMERA_H
@@ -1,4 +1,5 @@
 #include <math.h>
+#include "graphics.h"
 #include "window.h"
 #include "vec2.h"
 
@@ -26,20 +27,13 @@ void drawLineOnSurface(VWindow* window, vec2 start, vec2 end, unsigned int color
 }
 
 void drawRectangleOnSurface(VWindow* window, int x, int y, int width, int height, unsigned int color, unsigned int thickness) {
-    // Draw top and bottom horizontal lines
-    for (int i = 0; i < width; i++) {
-        for (int t = 0; t < thickness; t++) {
-            setPixel(window->surface, x + i, y + t, color, 0);
-            setPixel(window->surface, x + i, y + height - 1 - t, color, 0);
-        }
-    }
-    // Draw left and right vertical lines
-    for (int i = 0; i < height; i++) {
-        for (int t = 0; t < thickness; t++) {
-            setPixel(window->surface, x + t, y + i, color, 0);
-            setPixel(window->surface, x + width - 1 - t, y + i, color, 0);
-        }
-    }
+    int t = (int)thickness;
+    // Draw top and bottom horizontal bands
+    fillRect(window->surface, x, y, width, t, color);
+    fillRect(window->surface, x, y + height - t, width, t, color);
+    // Draw left and right vertical bands
+    fillRect(window->surface, x, y, t, height, color);
+    fillRect(window->surface, x + width - t, y, t, height, color);
 }
 
 // Helper function to calculate intensity based on distance
@@ -107,4 +101,24 @@ void drawLineOnSurface2(VWindow* window, vec2 start, vec2 end, unsigned int colo
             err += dx; y0 += sy;
         }
     }
-}
\ No newline at end of file
+}
+
+void fillPolygonOnSurface(VWindow* window, const vec2* points, int count, unsigned int color, bool antialias)
+{
+    fillPolygon(window->surface, points, count, color, FILL_NONZERO, antialias);
+}
+
+void fillCircleOnSurface(VWindow* window, vec2 center, float radius, unsigned int color, bool antialias)
+{
+    fillCircle(window->surface, center, radius, color, antialias);
+}
+
+void fillEllipseOnSurface(VWindow* window, vec2 center, float radiusX, float radiusY, unsigned int color, bool antialias)
+{
+    fillEllipse(window->surface, center, radiusX, radiusY, color, antialias);
+}
+
+void fillRoundedRectOnSurface(VWindow* window, int x, int y, int width, int height, float radius, unsigned int color, bool antialias)
+{
+    fillRoundedRect(window->surface, (float)x, (float)y, (float)width, (float)height, radius, color, antialias);
+}
@@ -4,6 +4,7 @@
 #include "window.h"
 #include "define.h"
 #include "vec2.h"
+#include "raster.h"
 
 // Function to draw a point on the surface
 void drawPointOnSurface(VWindow* window, int x, int y, unsigned int color, unsigned int size);
@@ -23,4 +24,16 @@ unsigned int blendColors(unsigned int bg, unsigned int fg, float alpha);
 // Function to draw a line on the surface using Gupta-Sproull algorithm
 void drawLineOnSurface2(VWindow* window, vec2 start, vec2 end, unsigned int color, unsigned int thickness);
 
+// Function to fill a convex or concave polygon on the surface using the scanline rasterizer
+void fillPolygonOnSurface(VWindow* window, const vec2* points, int count, unsigned int color, bool antialias);
+
+// Function to fill a circle on the surface
+void fillCircleOnSurface(VWindow* window, vec2 center, float radius, unsigned int color, bool antialias);
+
+// Function to fill an ellipse on the surface
+void fillEllipseOnSurface(VWindow* window, vec2 center, float radiusX, float radiusY, unsigned int color, bool antialias);
+
+// Function to fill a rectangle with rounded corners on the surface
+void fillRoundedRectOnSurface(VWindow* window, int x, int y, int width, int height, float radius, unsigned int color, bool antialias);
+
 #endif // GRAPHICS_H
\ No newline at end of file
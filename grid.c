@@ -0,0 +1,225 @@
+#include "spatial.h"
+
+#include <math.h>
+#include <string.h>
+
+// Uniform grid backend: cells sized for a few points each, stored as one
+// array sorted by cell (counting sort) plus per-cell start offsets.
+
+#define GRID_POINTS_PER_CELL 4
+#define GRID_MAX_CELLS (1 << 22)
+
+typedef struct GridIndex
+{
+    SpatialIndex base;
+    vec2* points;       // every accepted point, in insertion order
+    int count;
+    int capacity;
+
+    vec2* cellPoints;   // the same points grouped by cell
+    int* cellStart;     // cellsX * cellsY + 1 offsets into cellPoints
+    int cellsX, cellsY;
+    float minX, minY;
+    float cellW, cellH;
+    bool dirty;         // points were added since the cells were rebuilt
+} GridIndex;
+
+static int gridCellX(const GridIndex* grid, float x)
+{
+    int cx = (int)((x - grid->minX) / grid->cellW);
+    return cx < 0 ? 0 : (cx >= grid->cellsX ? grid->cellsX - 1 : cx);
+}
+
+static int gridCellY(const GridIndex* grid, float y)
+{
+    int cy = (int)((y - grid->minY) / grid->cellH);
+    return cy < 0 ? 0 : (cy >= grid->cellsY ? grid->cellsY - 1 : cy);
+}
+
+static bool gridRebuild(GridIndex* grid)
+{
+    AABB b = grid->base.bounds;
+    int cells = grid->count / GRID_POINTS_PER_CELL;
+    if (cells < 1) cells = 1;
+    if (cells > GRID_MAX_CELLS) cells = GRID_MAX_CELLS;
+
+    // Roughly square cells over the bounds
+    int cellsX = (int)ceilf(sqrtf((float)cells * b.halfWidth / b.halfHeight));
+    if (cellsX < 1) cellsX = 1;
+    int cellsY = (cells + cellsX - 1) / cellsX;
+
+    int* cellStart = (int*)calloc((size_t)cellsX * cellsY + 1, sizeof(int));
+    int* cellOf = (int*)malloc((grid->count > 0 ? grid->count : 1) * sizeof(int));
+    vec2* cellPoints = (vec2*)malloc((grid->count > 0 ? grid->count : 1) * sizeof(vec2));
+    if (!cellStart || !cellOf || !cellPoints) {
+        fprintf(stderr, "Failed to allocate grid cells\n");
+        free(cellStart);
+        free(cellOf);
+        free(cellPoints);
+        return false;
+    }
+
+    free(grid->cellStart);
+    free(grid->cellPoints);
+    grid->cellStart = cellStart;
+    grid->cellPoints = cellPoints;
+    grid->cellsX = cellsX;
+    grid->cellsY = cellsY;
+    grid->minX = b.center.x - b.halfWidth;
+    grid->minY = b.center.y - b.halfHeight;
+    grid->cellW = 2.0f * b.halfWidth / cellsX;
+    grid->cellH = 2.0f * b.halfHeight / cellsY;
+
+    for (int i = 0; i < grid->count; i++) {
+        cellOf[i] = gridCellY(grid, grid->points[i].y) * cellsX + gridCellX(grid, grid->points[i].x);
+        cellStart[cellOf[i] + 1]++;
+    }
+    for (int c = 0; c < cellsX * cellsY; c++) {
+        cellStart[c + 1] += cellStart[c];
+    }
+    // Scatter, using cellStart as the cursor and shifting it back afterwards
+    for (int i = 0; i < grid->count; i++) {
+        cellPoints[cellStart[cellOf[i]]++] = grid->points[i];
+    }
+    memmove(cellStart + 1, cellStart, (size_t)cellsX * cellsY * sizeof(int));
+    cellStart[0] = 0;
+
+    free(cellOf);
+    grid->dirty = false;
+    return true;
+}
+
+static bool gridReserve(GridIndex* grid, int extra)
+{
+    if (grid->count + extra <= grid->capacity) return true;
+    int capacity = grid->capacity > 0 ? grid->capacity : 64;
+    while (capacity < grid->count + extra) capacity *= 2;
+    vec2* points = (vec2*)realloc(grid->points, capacity * sizeof(vec2));
+    if (!points) return false;
+    grid->points = points;
+    grid->capacity = capacity;
+    return true;
+}
+
+static SpatialIndex* gridCreate(AABB bounds)
+{
+    GridIndex* grid = (GridIndex*)calloc(1, sizeof(GridIndex));
+    if (!grid) return NULL;
+    grid->base.bounds = bounds;
+    grid->dirty = true;
+    return &grid->base;
+}
+
+static void gridDestroy(SpatialIndex* base)
+{
+    GridIndex* grid = (GridIndex*)base;
+    free(grid->points);
+    free(grid->cellPoints);
+    free(grid->cellStart);
+    free(grid);
+}
+
+static bool gridInsert(SpatialIndex* base, vec2 p)
+{
+    GridIndex* grid = (GridIndex*)base;
+    if (!containsPoint(base->bounds, p) || !gridReserve(grid, 1)) return false;
+    grid->points[grid->count++] = p;
+    grid->dirty = true;  // cells are rebuilt by the next query
+    return true;
+}
+
+static void gridBuild(SpatialIndex* base, const vec2* points, int count)
+{
+    GridIndex* grid = (GridIndex*)base;
+    if (!gridReserve(grid, count)) return;
+    for (int i = 0; i < count; i++) {
+        if (containsPoint(base->bounds, points[i])) grid->points[grid->count++] = points[i];
+    }
+    gridRebuild(grid);
+}
+
+static int gridQueryRange(SpatialIndex* base, AABB range, vec2* found, int maxFound)
+{
+    GridIndex* grid = (GridIndex*)base;
+    if (grid->dirty && !gridRebuild(grid)) return 0;
+    if (!intersectsAABB(base->bounds, range)) return 0;
+
+    int cx0 = gridCellX(grid, range.center.x - range.halfWidth);
+    int cx1 = gridCellX(grid, range.center.x + range.halfWidth);
+    int cy0 = gridCellY(grid, range.center.y - range.halfHeight);
+    int cy1 = gridCellY(grid, range.center.y + range.halfHeight);
+
+    int count = 0;
+    for (int cy = cy0; cy <= cy1 && count < maxFound; cy++) {
+        for (int cx = cx0; cx <= cx1 && count < maxFound; cx++) {
+            int c = cy * grid->cellsX + cx;
+            const vec2* points = grid->cellPoints + grid->cellStart[c];
+            int n = grid->cellStart[c + 1] - grid->cellStart[c];
+
+            // Cells strictly inside the range need no per-point test
+            if (cx > cx0 && cx < cx1 && cy > cy0 && cy < cy1) {
+                if (n > maxFound - count) n = maxFound - count;
+                memcpy(found + count, points, n * sizeof(vec2));
+                count += n;
+                continue;
+            }
+            for (int i = 0; i < n && count < maxFound; i++) {
+                if (containsPoint(range, points[i])) found[count++] = points[i];
+            }
+        }
+    }
+    return count;
+}
+
+static bool gridNearest(SpatialIndex* base, vec2 target, vec2* nearest)
+{
+    GridIndex* grid = (GridIndex*)base;
+    if (grid->dirty && !gridRebuild(grid)) return false;
+    if (grid->count == 0) return false;
+
+    int cx = gridCellX(grid, target.x);
+    int cy = gridCellY(grid, target.y);
+    int maxRing = grid->cellsX > grid->cellsY ? grid->cellsX : grid->cellsY;
+    float best = INFINITY;
+
+    // Search rings of cells around the target's cell, stopping once the next ring is farther than the best hit
+    for (int r = 0; r <= maxRing; r++) {
+        if (r > 0) {
+            float x0 = grid->minX + (cx - r + 1) * grid->cellW, x1 = grid->minX + (cx + r) * grid->cellW;
+            float y0 = grid->minY + (cy - r + 1) * grid->cellH, y1 = grid->minY + (cy + r) * grid->cellH;
+            float gap = fminf(fminf(target.x - x0, x1 - target.x), fminf(target.y - y0, y1 - target.y));
+            if (gap > 0.0f && gap * gap >= best) break;
+        }
+
+        for (int y = cy - r; y <= cy + r; y++) {
+            if (y < 0 || y >= grid->cellsY) continue;
+            bool edgeRow = y == cy - r || y == cy + r;
+            for (int x = cx - r; x <= cx + r; x += edgeRow ? 1 : 2 * r) {
+                if (x >= 0 && x < grid->cellsX) {
+                    int c = y * grid->cellsX + x;
+                    for (int i = grid->cellStart[c]; i < grid->cellStart[c + 1]; i++) {
+                        float dx = grid->cellPoints[i].x - target.x;
+                        float dy = grid->cellPoints[i].y - target.y;
+                        float d = dx * dx + dy * dy;
+                        if (d < best) {
+                            best = d;
+                            *nearest = grid->cellPoints[i];
+                        }
+                    }
+                }
+                if (r == 0) break;
+            }
+        }
+    }
+    return best < INFINITY;
+}
+
+const SpatialIndexOps gridIndexOps = {
+    "grid",
+    gridCreate,
+    gridDestroy,
+    gridInsert,
+    gridBuild,
+    gridQueryRange,
+    gridNearest,
+};
@@ -0,0 +1,251 @@
+#include "spatial.h"
+
+#include <math.h>
+#include <string.h>
+
+// k-d tree backend: an implicit balanced tree over a single point array.
+// Each node is a range [lo, hi) whose median point, at mid, splits it along the
+// longer side of its box into [lo, mid) and [mid + 1, hi). The box is recomputed
+// during traversal so nothing else is stored.
+
+#define KD_LEAF_SIZE 8
+
+typedef struct KdBox
+{
+    float minX, minY, maxX, maxY;
+} KdBox;
+
+typedef struct KdTreeIndex
+{
+    SpatialIndex base;
+    vec2* points;
+    int count;
+    int capacity;
+    bool dirty;     // points were appended since the last partition
+} KdTreeIndex;
+
+static inline float axisValue(vec2 p, int axis)
+{
+    return axis == 0 ? p.x : p.y;
+}
+
+static inline int splitAxis(KdBox box)
+{
+    return (box.maxX - box.minX) >= (box.maxY - box.minY) ? 0 : 1;
+}
+
+// Quickselect: afterwards points[k] is in sorted position along axis within [lo, hi)
+static void selectNth(vec2* points, int lo, int hi, int k, int axis)
+{
+    while (hi - lo > 1) {
+        float pivot = axisValue(points[lo + (hi - lo) / 2], axis);
+        int i = lo, j = hi - 1;
+        while (i <= j) {
+            while (axisValue(points[i], axis) < pivot) i++;
+            while (axisValue(points[j], axis) > pivot) j--;
+            if (i <= j) {
+                vec2 t = points[i];
+                points[i] = points[j];
+                points[j] = t;
+                i++;
+                j--;
+            }
+        }
+        if (k <= j) hi = j + 1;
+        else if (k >= i) lo = i;
+        else return;
+    }
+}
+
+static void kdPartition(vec2* points, int lo, int hi, KdBox box)
+{
+    if (hi - lo <= KD_LEAF_SIZE) return;
+
+    int axis = splitAxis(box);
+    int mid = lo + (hi - lo) / 2;
+    selectNth(points, lo, hi, mid, axis);
+    float split = axisValue(points[mid], axis);
+
+    KdBox left = box, right = box;
+    if (axis == 0) { left.maxX = split; right.minX = split; }
+    else { left.maxY = split; right.minY = split; }
+    kdPartition(points, lo, mid, left);
+    kdPartition(points, mid + 1, hi, right);
+}
+
+static KdBox rootBox(const SpatialIndex* base)
+{
+    AABB b = base->bounds;
+    KdBox box = {b.center.x - b.halfWidth, b.center.y - b.halfHeight,
+                 b.center.x + b.halfWidth, b.center.y + b.halfHeight};
+    return box;
+}
+
+static void kdRebuild(KdTreeIndex* kd)
+{
+    kdPartition(kd->points, 0, kd->count, rootBox(&kd->base));
+    kd->dirty = false;
+}
+
+static bool kdReserve(KdTreeIndex* kd, int extra)
+{
+    if (kd->count + extra <= kd->capacity) return true;
+    int capacity = kd->capacity > 0 ? kd->capacity : 64;
+    while (capacity < kd->count + extra) capacity *= 2;
+    vec2* points = (vec2*)realloc(kd->points, capacity * sizeof(vec2));
+    if (!points) return false;
+    kd->points = points;
+    kd->capacity = capacity;
+    return true;
+}
+
+static SpatialIndex* kdCreate(AABB bounds)
+{
+    KdTreeIndex* kd = (KdTreeIndex*)calloc(1, sizeof(KdTreeIndex));
+    if (!kd) return NULL;
+    kd->base.bounds = bounds;
+    return &kd->base;
+}
+
+static void kdDestroy(SpatialIndex* base)
+{
+    KdTreeIndex* kd = (KdTreeIndex*)base;
+    free(kd->points);
+    free(kd);
+}
+
+static bool kdInsert(SpatialIndex* base, vec2 p)
+{
+    KdTreeIndex* kd = (KdTreeIndex*)base;
+    if (!containsPoint(base->bounds, p) || !kdReserve(kd, 1)) return false;
+    kd->points[kd->count++] = p;
+    kd->dirty = true;  // repartitioned by the next query
+    return true;
+}
+
+static void kdBuild(SpatialIndex* base, const vec2* points, int count)
+{
+    KdTreeIndex* kd = (KdTreeIndex*)base;
+    if (!kdReserve(kd, count)) return;
+    for (int i = 0; i < count; i++) {
+        if (containsPoint(base->bounds, points[i])) kd->points[kd->count++] = points[i];
+    }
+    kdRebuild(kd);
+}
+
+static int kdQueryNode(const vec2* points, int lo, int hi, KdBox box, KdBox range, vec2* found, int maxFound)
+{
+    if (maxFound <= 0 || lo >= hi) return 0;
+    if (box.maxX < range.minX || box.minX > range.maxX || box.maxY < range.minY || box.minY > range.maxY) return 0;
+
+    // Node entirely inside the range: its points are one contiguous run
+    if (box.minX >= range.minX && box.maxX <= range.maxX && box.minY >= range.minY && box.maxY <= range.maxY) {
+        int n = hi - lo < maxFound ? hi - lo : maxFound;
+        memcpy(found, points + lo, n * sizeof(vec2));
+        return n;
+    }
+
+    if (hi - lo <= KD_LEAF_SIZE) {
+        int count = 0;
+        for (int i = lo; i < hi && count < maxFound; i++) {
+            vec2 p = points[i];
+            if (p.x >= range.minX && p.x <= range.maxX && p.y >= range.minY && p.y <= range.maxY) {
+                found[count++] = p;
+            }
+        }
+        return count;
+    }
+
+    int axis = splitAxis(box);
+    int mid = lo + (hi - lo) / 2;
+    float split = axisValue(points[mid], axis);
+    KdBox left = box, right = box;
+    if (axis == 0) { left.maxX = split; right.minX = split; }
+    else { left.maxY = split; right.minY = split; }
+
+    int count = kdQueryNode(points, lo, mid, left, range, found, maxFound);
+    vec2 p = points[mid];
+    if (count < maxFound && p.x >= range.minX && p.x <= range.maxX && p.y >= range.minY && p.y <= range.maxY) {
+        found[count++] = p;
+    }
+    count += kdQueryNode(points, mid + 1, hi, right, range, found + count, maxFound - count);
+    return count;
+}
+
+static int kdQueryRange(SpatialIndex* base, AABB range, vec2* found, int maxFound)
+{
+    KdTreeIndex* kd = (KdTreeIndex*)base;
+    if (kd->dirty) kdRebuild(kd);
+
+    KdBox r = {range.center.x - range.halfWidth, range.center.y - range.halfHeight,
+               range.center.x + range.halfWidth, range.center.y + range.halfHeight};
+    return kdQueryNode(kd->points, 0, kd->count, rootBox(base), r, found, maxFound);
+}
+
+static float boxDistanceSquared(KdBox box, vec2 p)
+{
+    float dx = fmaxf(fmaxf(box.minX - p.x, p.x - box.maxX), 0.0f);
+    float dy = fmaxf(fmaxf(box.minY - p.y, p.y - box.maxY), 0.0f);
+    return dx * dx + dy * dy;
+}
+
+static void kdNearestNode(const vec2* points, int lo, int hi, KdBox box, vec2 target, vec2* best, float* bestDistance)
+{
+    if (lo >= hi || boxDistanceSquared(box, target) >= *bestDistance) return;
+
+    if (hi - lo <= KD_LEAF_SIZE) {
+        for (int i = lo; i < hi; i++) {
+            float dx = points[i].x - target.x;
+            float dy = points[i].y - target.y;
+            float d = dx * dx + dy * dy;
+            if (d < *bestDistance) {
+                *bestDistance = d;
+                *best = points[i];
+            }
+        }
+        return;
+    }
+
+    int axis = splitAxis(box);
+    int mid = lo + (hi - lo) / 2;
+    float split = axisValue(points[mid], axis);
+    KdBox left = box, right = box;
+    if (axis == 0) { left.maxX = split; right.minX = split; }
+    else { left.maxY = split; right.minY = split; }
+
+    float dx = points[mid].x - target.x;
+    float dy = points[mid].y - target.y;
+    if (dx * dx + dy * dy < *bestDistance) {
+        *bestDistance = dx * dx + dy * dy;
+        *best = points[mid];
+    }
+
+    // Near side first
+    if (axisValue(target, axis) < split) {
+        kdNearestNode(points, lo, mid, left, target, best, bestDistance);
+        kdNearestNode(points, mid + 1, hi, right, target, best, bestDistance);
+    } else {
+        kdNearestNode(points, mid + 1, hi, right, target, best, bestDistance);
+        kdNearestNode(points, lo, mid, left, target, best, bestDistance);
+    }
+}
+
+static bool kdNearest(SpatialIndex* base, vec2 target, vec2* nearest)
+{
+    KdTreeIndex* kd = (KdTreeIndex*)base;
+    if (kd->dirty) kdRebuild(kd);
+
+    float bestDistance = INFINITY;
+    kdNearestNode(kd->points, 0, kd->count, rootBox(base), target, nearest, &bestDistance);
+    return bestDistance < INFINITY;
+}
+
+const SpatialIndexOps kdTreeIndexOps = {
+    "kdtree",
+    kdCreate,
+    kdDestroy,
+    kdInsert,
+    kdBuild,
+    kdQueryRange,
+    kdNearest,
+};
@@ -0,0 +1,149 @@
+#include "layer.h"
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+bool initLayer(Layer* layer, int width, int height, bool visible)
+{
+    layer->surface = createSurface(width, height);
+    layer->visible = visible;
+    markLayerAllDirty(layer);
+    return layer->surface != NULL;
+}
+
+void freeLayer(Layer* layer)
+{
+    if (layer->surface) {
+        freeSurface(layer->surface);
+        layer->surface = NULL;
+    }
+}
+
+void markLayerDirty(Layer* layer, int y0, int y1)
+{
+    if (y0 < 0) y0 = 0;
+    if (y1 > layer->surface->height) y1 = layer->surface->height;
+    if (y0 >= y1) return;
+
+    if (!layer->dirty) {
+        layer->dirty = true;
+        layer->dirtyMinY = y0;
+        layer->dirtyMaxY = y1;
+    } else {
+        if (y0 < layer->dirtyMinY) layer->dirtyMinY = y0;
+        if (y1 > layer->dirtyMaxY) layer->dirtyMaxY = y1;
+    }
+}
+
+void markLayerAllDirty(Layer* layer)
+{
+    layer->dirty = true;
+    layer->dirtyMinY = 0;
+    layer->dirtyMaxY = layer->surface ? layer->surface->height : 0;
+}
+
+void setLayerVisible(Layer* layer, bool visible)
+{
+    if (layer->visible == visible) return;
+    layer->visible = visible;
+    // Showing or hiding changes everything the layer covers
+    markLayerAllDirty(layer);
+}
+
+bool layersDirtyRows(const Layer* layers, int count, int* y0, int* y1)
+{
+    bool dirty = false;
+    for (int i = 0; i < count; i++) {
+        if (!layers[i].dirty) continue;
+        if (!dirty || layers[i].dirtyMinY < *y0) *y0 = layers[i].dirtyMinY;
+        if (!dirty || layers[i].dirtyMaxY > *y1) *y1 = layers[i].dirtyMaxY;
+        dirty = true;
+    }
+    return dirty;
+}
+
+// dst = src over dst, straight alpha; x / 255 is computed as (x + 128 + ((x + 128) >> 8)) >> 8
+static inline unsigned int blendPixel(unsigned int dst, unsigned int src)
+{
+    unsigned int a = src >> 24;
+    if (a == 0) return dst;
+    if (a == 0xFF) return src;
+
+    unsigned int out = 0xFF000000;
+    for (int shift = 0; shift < 24; shift += 8) {
+        unsigned int s = (src >> shift) & 0xFF;
+        unsigned int d = (dst >> shift) & 0xFF;
+        unsigned int t = s * a + d * (255 - a) + 128;
+        out |= (((t + (t >> 8)) >> 8) & 0xFF) << shift;
+    }
+    return out;
+}
+
+static void blendRow(unsigned int* dst, const unsigned int* src, int count)
+{
+    int x = 0;
+#if defined(__SSE2__)
+    const __m128i alphaMask = _mm_set1_epi32((int)0xFF000000);
+    const __m128i zero = _mm_setzero_si128();
+    const __m128i full = _mm_set1_epi16(255);
+    const __m128i round = _mm_set1_epi16(128);
+
+    for (; x + 4 <= count; x += 4) {
+        __m128i s = _mm_loadu_si128((const __m128i*)(src + x));
+        __m128i alpha = _mm_and_si128(s, alphaMask);
+
+        // Overlays are mostly empty or solid, so test for both before doing any math
+        int transparent = _mm_movemask_epi8(_mm_cmpeq_epi32(alpha, zero));
+        if (transparent == 0xFFFF) continue;
+        int opaque = _mm_movemask_epi8(_mm_cmpeq_epi32(alpha, alphaMask));
+        if (opaque == 0xFFFF) {
+            _mm_storeu_si128((__m128i*)(dst + x), s);
+            continue;
+        }
+
+        __m128i d = _mm_loadu_si128((const __m128i*)(dst + x));
+        __m128i result[2];
+        for (int half = 0; half < 2; half++) {
+            __m128i s16 = half ? _mm_unpackhi_epi8(s, zero) : _mm_unpacklo_epi8(s, zero);
+            __m128i d16 = half ? _mm_unpackhi_epi8(d, zero) : _mm_unpacklo_epi8(d, zero);
+            __m128i a16 = _mm_shufflehi_epi16(_mm_shufflelo_epi16(s16, 0xFF), 0xFF);
+            __m128i t = _mm_add_epi16(_mm_add_epi16(_mm_mullo_epi16(s16, a16),
+                                                    _mm_mullo_epi16(d16, _mm_sub_epi16(full, a16))), round);
+            result[half] = _mm_srli_epi16(_mm_add_epi16(t, _mm_srli_epi16(t, 8)), 8);
+        }
+        __m128i out = _mm_or_si128(_mm_packus_epi16(result[0], result[1]), alphaMask);
+        _mm_storeu_si128((__m128i*)(dst + x), out);
+    }
+#endif
+    for (; x < count; x++) {
+        dst[x] = blendPixel(dst[x], src[x]);
+    }
+}
+
+void compositeLayers(Layer* layers, int count, unsigned int* dest, int destStride, int y0, int y1)
+{
+    int base = -1;
+    for (int i = 0; i < count; i++) {
+        if (layers[i].visible && layers[i].surface) { base = i; break; }
+    }
+
+    for (int y = y0; y < y1; y++) {
+        unsigned int* dst = dest + y * destStride;
+        if (base < 0) {
+            memset(dst, 0, layers[0].surface->width * sizeof(unsigned int));
+            continue;
+        }
+
+        int width = layers[base].surface->width;
+        memcpy(dst, layers[base].surface->pixels + y * width, width * sizeof(unsigned int));
+        for (int i = base + 1; i < count; i++) {
+            if (!layers[i].visible) continue;
+            blendRow(dst, layers[i].surface->pixels + y * width, width);
+        }
+    }
+
+    for (int i = 0; i < count; i++) {
+        layers[i].dirty = false;
+    }
+}
@@ -0,0 +1,38 @@
+#ifndef LAYER_H
+#define LAYER_H
+
+#include <stdbool.h>
+
+#include "surface.h"
+
+/*
+ * A layer is a Surface composited over the layers beneath it. Pixels use the
+ * 0xAARRGGBB layout of the rest of the code; alpha 0 is fully transparent.
+ * The bottom visible layer is copied as is, so it should be opaque.
+ *
+ * Dirty rows accumulate until the next compositeLayers call, which only
+ * touches the union of the rows that changed.
+ */
+typedef struct Layer
+{
+    Surface* surface;
+    bool visible;
+    bool dirty;
+    int dirtyMinY;  // rows [dirtyMinY, dirtyMaxY) changed since the last composite
+    int dirtyMaxY;
+} Layer;
+
+bool initLayer(Layer* layer, int width, int height, bool visible);
+void freeLayer(Layer* layer);
+
+void markLayerDirty(Layer* layer, int y0, int y1);
+void markLayerAllDirty(Layer* layer);
+void setLayerVisible(Layer* layer, bool visible);
+
+// Union of the dirty rows of all layers; returns false when nothing changed
+bool layersDirtyRows(const Layer* layers, int count, int* y0, int* y1);
+
+// Composites rows [y0, y1) of every visible layer into dest and clears the dirty state
+void compositeLayers(Layer* layers, int count, unsigned int* dest, int destStride, int y0, int y1);
+
+#endif //LAYER_H
@@ -1,22 +1,51 @@
 #include <unistd.h>  // For usleep
+#include <time.h>
 #include "random.h"
 #include "window.h"
 #include "quadtree.h"
+#include "snapshot.h"
+#include "memtrack.h"
+#include "resolution.h"
+#include "raster.h"
 #include "define.h"
 
 
 #define WIDTH 1200
 #define HEIGHT 1200
 
-int main() 
+#define DEFAULT_POINT_COUNT 1000
+#define POINT_FILL_FRAMES 1000  // frames over which the target point count is inserted
+#define HUD_HEIGHT 70           // rows of the HUD layer cleared when the text changes
+#define HUD_PANEL_COLOR 0xA0000000  // translucent backdrop that keeps the text readable over dense points
+
+static double elapsedMs(struct timespec start)
+{
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return (now.tv_sec - start.tv_sec) * 1000.0 + (now.tv_nsec - start.tv_nsec) / 1e6;
+}
+
+// Usage: cdraw [pointCount] [--save snapshot] [--load snapshot]
+int main(int argc, char** argv) 
 {
-    // Seed the random number generator with a constant value for reproducibility
-    srand(time(NULL));
+    // Seed the random number generator; pass a constant instead for reproducibility
+    rngSeed((uint64_t)time(NULL));
 
     float fhalfWidth = WIDTH/2.0f;
     float fhalfHeight = HEIGHT/2.0f;
     vec2 rootQuadCenter = {fhalfWidth, fhalfHeight};
 
+    int targetPoints = DEFAULT_POINT_COUNT;
+    const char* savePath = NULL;
+    const char* loadPath = NULL;
+    for (int i = 1; i < argc; i++)
+    {
+        if (strcmp(argv[i], "--save") == 0 && i + 1 < argc) savePath = argv[++i];
+        else if (strcmp(argv[i], "--load") == 0 && i + 1 < argc) loadPath = argv[++i];
+        else targetPoints = atoi(argv[i]);
+    }
+    if (targetPoints < 0) targetPoints = 0;
+
     VWindow* window = createWindow(WIDTH, HEIGHT);
     ASSERT(window != NULL);
 
@@ -28,57 +57,178 @@ int main()
         return 1;
     }
 
-    window->width = WIDTH;
-    window->height = HEIGHT;
-
     XSetForeground(window->display, window->gc, LIGHT_GRAY);
    
     int pointCount = 0;
-    clearColor(window, BLACK);
+    struct timespec start;
+
+    // A loaded snapshot is drawn in place of the live tree until 'r' regenerates
+    QuadSnapshot* snapshot = NULL;
+    if (loadPath)
+    {
+        clock_gettime(CLOCK_MONOTONIC, &start);
+        snapshot = openQuadSnapshot(loadPath);
+        if (snapshot)
+        {
+            pointCount = targetPoints = (int)snapshot->header->pointCount;
+            printf("Loaded %s (%d points) in %.2f ms\n", loadPath, pointCount, elapsedMs(start));
+        }
+    }
+
+    // Sized from the final target, which a loaded snapshot replaces, so 'r' refills at the same pace
+    int batchSize = targetPoints / POINT_FILL_FRAMES > 0 ? targetPoints / POINT_FILL_FRAMES : 1;
+    vec2* batch = (vec2*)malloc(batchSize * sizeof(vec2));
+    ASSERT(batch != NULL);
+
+    // Saving builds the whole tree up front rather than over POINT_FILL_FRAMES
+    if (savePath && !snapshot)
+    {
+        clock_gettime(CLOCK_MONOTONIC, &start);
+        while (pointCount < targetPoints)
+        {
+            int n = targetPoints - pointCount < batchSize ? targetPoints - pointCount : batchSize;
+            randClustered(batch, n, WIDTH, HEIGHT, 0.5f, 1.0f);
+            for (int i = 0; i < n; i++)
+            {
+                insert(rootQuad, batch[i]);
+            }
+            pointCount += n;
+        }
+        printf("Built %d points in %.2f ms\n", pointCount, elapsedMs(start));
+
+        clock_gettime(CLOCK_MONOTONIC, &start);
+        if (saveQuadTreeSnapshot(rootQuad, savePath))
+        {
+            printf("Saved %s in %.2f ms\n", savePath, elapsedMs(start));
+        }
+    }
+
+    // Layers are only re-rendered when what they show changed
+    bool sceneChanged = true;
+    bool quadsStale = true;
+    char hudText[384] = "";
+
+    // Resolution the scene renders at, adapted to the time the frames take
+    ResolutionController resolution;
+    initResolutionController(&resolution);
+    struct timespec frameStart;
 
     while (!window->shouldClose) 
     {
+        clock_gettime(CLOCK_MONOTONIC, &frameStart);
         
         if(window->randomize)
         {
             pointCount = 0;
+            closeQuadSnapshot(snapshot);
+            snapshot = NULL;
             freeQuadTree(rootQuad);
             rootQuad = constructQuadTree(rootQuadCenter, fhalfWidth, fhalfHeight);
-            clearColor(window, BLACK);
             window->randomize = false;
+            sceneChanged = true;
         } 
 
-        if(pointCount < 1000)
+        if(pointCount < targetPoints)
         {
-            vec2 p = {frand_clustered(window->width, 0.5f), frand_clustered(window->height, 1.0f)};
-            insert(rootQuad, p);
-            drawPoint(window, (int)p.x, (int)p.y, RED, 3);
-            pointCount++;
+            int n = targetPoints - pointCount < batchSize ? targetPoints - pointCount : batchSize;
+            randClustered(batch, n, WIDTH, HEIGHT, 0.5f, 1.0f);
+            for (int i = 0; i < n; i++)
+            {
+                insert(rootQuad, batch[i]);
+            }
+            pointCount += n;
+            sceneChanged = true;
         } 
 
-        // Draw the surface (red dots) to the window
-        drawSurfaceToWindow(window);
+        // Render the visible points (red dots) from the tree
+        bool sceneRendered = sceneChanged || window->viewChanged;
+        if (sceneRendered)
+        {
+            clearSurface(window->scene, BLACK);
+            if (snapshot) drawSnapshotPoints(window, snapshot, RED, 3);
+            else drawQuadTreePoints(window, rootQuad, RED, 3);
+            quadsStale = true;
+            sceneChanged = false;
+            window->viewChanged = false;
+        }
 
-        // Draw the QuadTree
-        if(window->drawQuads)
+        // Draw the QuadTree; while hidden it is left stale until shown again
+        if(window->drawQuads && quadsStale)
         {
-            drawQuadTree(window, rootQuad);
+            clearSurface(window->layers[LAYER_QUADS].surface, 0);
+            if (snapshot) drawSnapshot(window, snapshot);
+            else drawQuadTree(window, rootQuad);
+            quadsStale = false;
         }
 
         // Draw the text
         char buffer[256];
-        snprintf(buffer, sizeof(buffer), "Point Count: %d", pointCount);
-        drawText(window, 10, 30, buffer, WHITE, 32);
+        snprintf(buffer, sizeof(buffer), "Point Count: %d  Zoom: %.2fx  Res: %d%%%s%s", pointCount, window->camera.zoom,
+                 (int)(window->renderScale * 100.0f + 0.5f), window->bilinear ? " bilinear" : "",
+                 window->adaptiveResolution ? " (auto)" : "");
+
+        // Memory line: totals, quadtree cost per point and last frame's allocation churn
+        MemStats total = memTotalStats();
+        MemStats tree = memGetStats(MEM_QUADTREE);
+        char memory[128];
+        snprintf(memory, sizeof(memory), "Mem: %.1f MB (peak %.1f)  Tree: %.1f B/pt  Churn: %ld allocs, %.1f KB/frame",
+                 total.liveBytes / 1048576.0, total.peakBytes / 1048576.0,
+                 pointCount > 0 && !snapshot ? (double)tree.liveBytes / pointCount : 0.0,
+                 total.frameAllocs, total.frameBytes / 1024.0);
+
+        char hud[sizeof(hudText)];
+        snprintf(hud, sizeof(hud), "%s\n%s", buffer, memory);
+        if (strcmp(hud, hudText) != 0)
+        {
+            fillRect(window->layers[LAYER_HUD].surface, 0, 0, WIDTH, HUD_HEIGHT, 0);
+            markLayerDirty(&window->layers[LAYER_HUD], 0, HUD_HEIGHT);
+            int panelWidth = textWidth(window, buffer);
+            if (textWidth(window, memory) > panelWidth) panelWidth = textWidth(window, memory);
+            fillRoundedRect(window->layers[LAYER_HUD].surface, 4.0f, 6.0f, (float)(panelWidth + 12), HUD_HEIGHT - 8, 10.0f,
+                            HUD_PANEL_COLOR, true);
+            drawText(window, 10, 30, buffer, WHITE, 32);
+            drawText(window, 10, 60, memory, WHITE, 32);
+            strcpy(hudText, hud);
+        }
 
-        // Present the window (swap buffers)
-        presentWindow(window);
+        // Composite whatever changed and present it
+        drawSurfaceToWindow(window);
         
         handleEvents(window);
-        usleep(16667);  // ~60 FPS
+
+        // Only frames that redrew the scene say what a scale costs; a still view drifts back to full
+        // resolution instead. A new scale takes effect by redrawing the scene
+        if (window->adaptiveResolution)
+        {
+            bool rescaled = sceneRendered ? updateResolutionScale(&resolution, elapsedMs(frameStart))
+                                          : idleResolutionScale(&resolution);
+            if (rescaled)
+            {
+                if (!setRenderScale(window, resolution.scale)) resolution.scale = window->renderScale;
+                sceneChanged = true;
+            }
+        }
+        else if (window->renderScale < 1.0f)
+        {
+            initResolutionController(&resolution);
+            setRenderScale(window, 1.0f);
+            sceneChanged = true;
+        }
+
+        memEndFrame();
+
+        // Sleep off whatever is left of the frame budget
+        double remainingMs = FRAME_BUDGET_MS - elapsedMs(frameStart);
+        if (remainingMs > 0.0) usleep((useconds_t)(remainingMs * 1000.0));
     }
 
     // Clean up
+    closeQuadSnapshot(snapshot);
     freeQuadTree(rootQuad);
     destroyWindow(window);
+    free(batch);
+
+    // Anything still live here leaked
+    memReport(stdout);
     return 0;
 }
\ No newline at end of file
@@ -0,0 +1,133 @@
+#include "memtrack.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+static const char* subsystemNames[MEM_SUBSYSTEM_COUNT] = {"quadtree", "surface", "window"};
+
+typedef struct MemCounters
+{
+    MemStats stats;
+    long allocs;    // churn of the frame in progress
+    long frees;
+    size_t bytes;
+} MemCounters;
+
+static MemCounters counters[MEM_SUBSYSTEM_COUNT];
+static size_t totalLive;
+static size_t totalPeak;
+
+static void countAlloc(MemSubsystem subsystem, size_t size)
+{
+    MemCounters* c = &counters[subsystem];
+    c->stats.liveBytes += size;
+    if (c->stats.liveBytes > c->stats.peakBytes) c->stats.peakBytes = c->stats.liveBytes;
+    c->stats.allocCount++;
+    c->allocs++;
+    c->bytes += size;
+
+    totalLive += size;
+    if (totalLive > totalPeak) totalPeak = totalLive;
+}
+
+static void countFree(MemSubsystem subsystem, size_t size)
+{
+    MemCounters* c = &counters[subsystem];
+    c->stats.liveBytes -= size;
+    c->stats.freeCount++;
+    c->frees++;
+    totalLive -= size;
+}
+
+void* memAlloc(MemSubsystem subsystem, size_t size)
+{
+    void* ptr = malloc(size);
+    if (ptr) countAlloc(subsystem, size);
+    return ptr;
+}
+
+void* memCalloc(MemSubsystem subsystem, size_t count, size_t size)
+{
+    void* ptr = calloc(count, size);
+    if (ptr) countAlloc(subsystem, count * size);
+    return ptr;
+}
+
+void* memRealloc(MemSubsystem subsystem, void* ptr, size_t oldSize, size_t newSize)
+{
+    void* resized = realloc(ptr, newSize);
+    if (!resized) return NULL;
+    if (ptr) countFree(subsystem, oldSize);
+    countAlloc(subsystem, newSize);
+    return resized;
+}
+
+void memFree(MemSubsystem subsystem, void* ptr, size_t size)
+{
+    if (!ptr) return;
+    countFree(subsystem, size);
+    free(ptr);
+}
+
+void memEndFrame(void)
+{
+    for (int i = 0; i < MEM_SUBSYSTEM_COUNT; i++) {
+        MemCounters* c = &counters[i];
+        c->stats.frameAllocs = c->allocs;
+        c->stats.frameFrees = c->frees;
+        c->stats.frameBytes = c->bytes;
+        c->allocs = c->frees = 0;
+        c->bytes = 0;
+    }
+}
+
+MemStats memGetStats(MemSubsystem subsystem)
+{
+    return counters[subsystem].stats;
+}
+
+MemStats memTotalStats(void)
+{
+    MemStats total;
+    memset(&total, 0, sizeof(total));
+    for (int i = 0; i < MEM_SUBSYSTEM_COUNT; i++) {
+        const MemStats* s = &counters[i].stats;
+        total.allocCount += s->allocCount;
+        total.freeCount += s->freeCount;
+        total.frameAllocs += s->frameAllocs;
+        total.frameFrees += s->frameFrees;
+        total.frameBytes += s->frameBytes;
+    }
+    total.liveBytes = totalLive;
+    total.peakBytes = totalPeak;
+    return total;
+}
+
+const char* memSubsystemName(MemSubsystem subsystem)
+{
+    return subsystem < MEM_SUBSYSTEM_COUNT ? subsystemNames[subsystem] : "?";
+}
+
+bool memReport(FILE* out)
+{
+    fprintf(out, "%-10s %12s %12s %10s %10s\n", "subsystem", "live KB", "peak KB", "allocs", "frees");
+    bool leaked = false;
+    for (int i = 0; i < MEM_SUBSYSTEM_COUNT; i++) {
+        const MemStats* s = &counters[i].stats;
+        fprintf(out, "%-10s %12.1f %12.1f %10ld %10ld\n", subsystemNames[i],
+                s->liveBytes / 1024.0, s->peakBytes / 1024.0, s->allocCount, s->freeCount);
+    }
+    MemStats total = memTotalStats();
+    fprintf(out, "%-10s %12.1f %12.1f %10ld %10ld\n", "total",
+            total.liveBytes / 1024.0, total.peakBytes / 1024.0, total.allocCount, total.freeCount);
+
+    for (int i = 0; i < MEM_SUBSYSTEM_COUNT; i++) {
+        const MemStats* s = &counters[i].stats;
+        if (s->liveBytes > 0 || s->allocCount != s->freeCount) {
+            fprintf(out, "Leak: %s still holds %zu bytes in %ld blocks\n", subsystemNames[i],
+                    s->liveBytes, s->allocCount - s->freeCount);
+            leaked = true;
+        }
+    }
+    return !leaked;
+}
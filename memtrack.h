@@ -0,0 +1,52 @@
+#ifndef MEMTRACK_H
+#define MEMTRACK_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdio.h>
+
+/*
+ * Allocation accounting. Subsystems allocate through memAlloc/memFree, which
+ * wrap malloc/free and keep live, peak and count totals per subsystem plus
+ * the churn of the current frame. Callers pass the size back on free, so the
+ * returned blocks are plain malloc blocks (Xlib may free them, see window.c).
+ *
+ * Counters are not synchronized; allocate from the main thread only.
+ */
+typedef enum MemSubsystem
+{
+    MEM_QUADTREE,
+    MEM_SURFACE,
+    MEM_WINDOW,
+    MEM_SUBSYSTEM_COUNT
+} MemSubsystem;
+
+typedef struct MemStats
+{
+    size_t liveBytes;
+    size_t peakBytes;
+    long allocCount;       // since startup
+    long freeCount;
+    long frameAllocs;      // during the last finished frame
+    long frameFrees;
+    size_t frameBytes;     // bytes allocated during the last finished frame
+} MemStats;
+
+void* memAlloc(MemSubsystem subsystem, size_t size);
+void* memCalloc(MemSubsystem subsystem, size_t count, size_t size);
+void* memRealloc(MemSubsystem subsystem, void* ptr, size_t oldSize, size_t newSize);
+// size must match the one the block was allocated with; NULL is ignored
+void memFree(MemSubsystem subsystem, void* ptr, size_t size);
+
+// Closes the current frame: its churn becomes the frame* fields and the next frame starts at zero
+void memEndFrame(void);
+
+MemStats memGetStats(MemSubsystem subsystem);
+// Sum over all subsystems; the peak is of the combined live bytes, not a sum of peaks
+MemStats memTotalStats(void);
+const char* memSubsystemName(MemSubsystem subsystem);
+
+// Prints the per-subsystem table and anything still live; returns false when something leaked
+bool memReport(FILE* out);
+
+#endif //MEMTRACK_H
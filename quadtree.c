@@ -1,9 +1,12 @@
 #include "quadtree.h"
 #include "define.h"
+#include "memtrack.h"
+
+#include <math.h>
 
 QuadTree* constructQuadTree(vec2 center, float halfwidth, float halfheight) 
 {
-    QuadTree* quad = (QuadTree*)malloc(sizeof(QuadTree));
+    QuadTree* quad = (QuadTree*)memAlloc(MEM_QUADTREE, sizeof(QuadTree));
     if (quad == NULL) {exit(1); }
     AABB newBoundary = {center, halfwidth, halfheight};
     quad->boundary = newBoundary;
@@ -29,10 +32,20 @@ void freeQuadTree(QuadTree* quad)
     freeQuadTree(quad->northEast);
     freeQuadTree(quad->southWest);
     freeQuadTree(quad->southEast);
-    free(quad);
+    memFree(MEM_QUADTREE, quad, sizeof(QuadTree));
 }
 
-//bool intersectsAABB(AABB other) {};
+bool containsPoint(AABB box, vec2 p)
+{
+    return p.x >= box.center.x - box.halfWidth && p.x <= box.center.x + box.halfWidth &&
+           p.y >= box.center.y - box.halfHeight && p.y <= box.center.y + box.halfHeight;
+}
+
+bool intersectsAABB(AABB a, AABB b)
+{
+    return fabsf(a.center.x - b.center.x) <= a.halfWidth + b.halfWidth &&
+           fabsf(a.center.y - b.center.y) <= a.halfHeight + b.halfHeight;
+}
 
 void subdivide(QuadTree* quad)
 {
@@ -48,10 +61,10 @@ void subdivide(QuadTree* quad)
     vec2 se_center = {x + w/2, y - h/2};
 
     // Construct child QuadTrees
-    quad->northWest = constructQuadTree(nw_center, w/2, w/2);
-    quad->northEast = constructQuadTree(ne_center, w/2, w/2);
-    quad->southWest = constructQuadTree(sw_center, w/2, w/2);
-    quad->southEast = constructQuadTree(se_center, w/2, w/2);
+    quad->northWest = constructQuadTree(nw_center, w/2, h/2);
+    quad->northEast = constructQuadTree(ne_center, w/2, h/2);
+    quad->southWest = constructQuadTree(sw_center, w/2, h/2);
+    quad->southEast = constructQuadTree(se_center, w/2, h/2);
 }
 
 
@@ -62,10 +75,7 @@ bool insert(QuadTree* quad, vec2 p)
         return false;
     }
 
-    if (p.x < quad->boundary.center.x - quad->boundary.halfWidth ||
-        p.x > quad->boundary.center.x + quad->boundary.halfWidth ||
-        p.y < quad->boundary.center.y - quad->boundary.halfHeight ||
-        p.y > quad->boundary.center.y + quad->boundary.halfHeight) {
+    if (!containsPoint(quad->boundary, p)) {
         return false;
     }
 
@@ -104,48 +114,173 @@ bool insert(QuadTree* quad, vec2 p)
     return false; 
 }
 
+int queryRange(QuadTree* quad, AABB range, vec2* found, int maxFound)
+{
+    if (quad == NULL || maxFound <= 0 || !intersectsAABB(quad->boundary, range)) return 0;
+
+    int count = 0;
+    if (quad->northWest == NULL) {
+        for (int i = 0; i < quad->pointCount && count < maxFound; i++) {
+            if (containsPoint(range, quad->points[i])) {
+                found[count++] = quad->points[i];
+            }
+        }
+        return count;
+    }
+
+    count += queryRange(quad->northWest, range, found + count, maxFound - count);
+    count += queryRange(quad->northEast, range, found + count, maxFound - count);
+    count += queryRange(quad->southWest, range, found + count, maxFound - count);
+    count += queryRange(quad->southEast, range, found + count, maxFound - count);
+    return count;
+}
+
+// Squared distance from p to the closest point of box (0 inside)
+static float distanceSquaredToAABB(AABB box, vec2 p)
+{
+    float dx = fmaxf(fabsf(p.x - box.center.x) - box.halfWidth, 0.0f);
+    float dy = fmaxf(fabsf(p.y - box.center.y) - box.halfHeight, 0.0f);
+    return dx * dx + dy * dy;
+}
+
+static void nearestInQuad(QuadTree* quad, vec2 target, vec2* best, float* bestDistance)
+{
+    if (distanceSquaredToAABB(quad->boundary, target) >= *bestDistance) return;
+
+    if (quad->northWest == NULL) {
+        for (int i = 0; i < quad->pointCount; i++) {
+            float dx = quad->points[i].x - target.x;
+            float dy = quad->points[i].y - target.y;
+            float d = dx * dx + dy * dy;
+            if (d < *bestDistance) {
+                *bestDistance = d;
+                *best = quad->points[i];
+            }
+        }
+        return;
+    }
+
+    // Visit the quadrant holding the target first so the others are mostly pruned
+    QuadTree* children[4] = {quad->northWest, quad->northEast, quad->southWest, quad->southEast};
+    int first = (target.x >= quad->boundary.center.x ? 1 : 0) + (target.y < quad->boundary.center.y ? 2 : 0);
+    nearestInQuad(children[first], target, best, bestDistance);
+    for (int i = 0; i < 4; i++) {
+        if (i != first) nearestInQuad(children[i], target, best, bestDistance);
+    }
+}
+
+bool nearestPoint(QuadTree* quad, vec2 target, vec2* nearest)
+{
+    if (quad == NULL) return false;
+    float bestDistance = INFINITY;
+    nearestInQuad(quad, target, nearest, &bestDistance);
+    return bestDistance < INFINITY;
+}
+
+bool projectAABB(const Camera* cam, const AABB* boundary, float* x, float* y, float* w, float* h)
+{
+    vec2 corner = {boundary->center.x - boundary->halfWidth, boundary->center.y - boundary->halfHeight};
+    vec2 screen = worldToScreen(cam, corner);
+    *x = screen.x;
+    *y = screen.y;
+    *w = boundary->halfWidth * 2.0f * cam->zoom;
+    *h = boundary->halfHeight * 2.0f * cam->zoom;
+
+    return *x + *w >= 0.0f && *x <= (float)cam->viewWidth &&
+           *y + *h >= 0.0f && *y <= (float)cam->viewHeight;
+}
+
+void strokeScreenRect(Surface* surface, float x, float y, float w, float h, unsigned int color)
+{
+    // Clip to just outside the surface so the edges stay in int range; +1 makes neighbouring cells share edges
+    float x0 = fmaxf(x, -1.0f), y0 = fmaxf(y, -1.0f);
+    float x1 = fminf(x + w, (float)surface->width + 1.0f);
+    float y1 = fminf(y + h, (float)surface->height + 1.0f);
+    strokeRect(surface, (int)x0, (int)y0, (int)(x1 - x0) + 1, (int)(y1 - y0) + 1, color);
+}
+
+bool strokeQuadNode(const Camera* cam, Surface* target, const AABB* boundary, unsigned int color)
+{
+    float x, y, w, h;
+    if (!projectAABB(cam, boundary, &x, &y, &w, &h)) return false;
+    if (w < QUAD_OVERLAY_LOD_PIXELS && h < QUAD_OVERLAY_LOD_PIXELS) return false;
+
+    strokeScreenRect(target, x, y, w, h, color);
+    return true;
+}
+
+bool stampQuadNode(const Camera* cam, Surface* target, const AABB* boundary, bool leaf,
+                   const vec2* points, int pointCount, unsigned int color, int size)
+{
+    float x, y, w, h;
+    if (!projectAABB(cam, boundary, &x, &y, &w, &h)) return false;
+
+    // Once a node is no bigger than one dot, every point in it lands under the same stamp.
+    // A subdivided node always holds points; a leaf may be empty.
+    float lod = size > QUAD_LOD_PIXELS ? (float)size : QUAD_LOD_PIXELS;
+    if (w < lod && h < lod) {
+        if (!leaf || pointCount > 0) {
+            setPixel(target, (int)(x + w * 0.5f), (int)(y + h * 0.5f), color, size);
+        }
+        return false;
+    }
+
+    if (leaf) {
+        float limitX = (float)(cam->viewWidth + size);
+        float limitY = (float)(cam->viewHeight + size);
+        for (int i = 0; i < pointCount; i++) {
+            vec2 s = worldToScreen(cam, points[i]);
+            if (s.x < -size || s.x > limitX || s.y < -size || s.y > limitY) continue;
+            setPixel(target, (int)s.x, (int)s.y, color, size);
+        }
+        return false;
+    }
+    return true;
+}
+
+static void strokeQuadTree(VWindow* win, QuadTree* quad, Surface* target, unsigned int color)
+{
+    if (!strokeQuadNode(&win->camera, target, &quad->boundary, color)) return;
+
+    if (quad->northWest) strokeQuadTree(win, quad->northWest, target, color);
+    if (quad->northEast) strokeQuadTree(win, quad->northEast, target, color);
+    if (quad->southWest) strokeQuadTree(win, quad->southWest, target, color);
+    if (quad->southEast) strokeQuadTree(win, quad->southEast, target, color);
+}
+
 void drawQuadTree(VWindow* win, QuadTree* quad) 
 {
     if (quad == NULL) return;
 
-    // Set color to green
-    XSetForeground(win->display, win->gc, GREEN);
+    // Outlines go to their own layer, green over transparent
+    strokeQuadTree(win, quad, win->layers[LAYER_QUADS].surface, GREEN);
+    markLayerAllDirty(&win->layers[LAYER_QUADS]);
+}
 
-    // Calculate the position and size of this quadrant
-    int x = (int)(quad->boundary.center.x - quad->boundary.halfWidth);
-    int y = (int)(quad->boundary.center.y - quad->boundary.halfHeight);
-    int width = (int)(quad->boundary.halfWidth * 2);
-    int height = (int)(quad->boundary.halfHeight * 2);
+void eraseQuadTree(VWindow* win, QuadTree* quad) 
+{
+    if (quad == NULL) return;
 
-    // Draw this quad's boundary
-    XDrawRectangle(win->display, win->backBuffer, win->gc, x, y, width, height);
-    
-    // Recursively draw child quads
-    if (quad->northWest) drawQuadTree(win, quad->northWest);
-    if (quad->northEast) drawQuadTree(win, quad->northEast);
-    if (quad->southWest) drawQuadTree(win, quad->southWest);
-    if (quad->southEast) drawQuadTree(win, quad->southEast);
+    // Transparent outlines: the points underneath are left alone
+    strokeQuadTree(win, quad, win->layers[LAYER_QUADS].surface, 0);
+    markLayerAllDirty(&win->layers[LAYER_QUADS]);
 }
 
-void eraseQuadTree(VWindow* win, QuadTree* quad) 
+static void stampQuadTree(const Camera* cam, Surface* target, QuadTree* quad, unsigned int color, int size)
 {
     if (quad == NULL) return;
+    if (!stampQuadNode(cam, target, &quad->boundary, quad->northWest == NULL, quad->points, quad->pointCount, color, size)) return;
 
-    // Set color to black (assuming 0 is black in your color scheme)
-    XSetForeground(win->display, win->gc, BLACK);
-
-    // Calculate the position and size of this quadrant
-    int x = (int)(quad->boundary.center.x - quad->boundary.halfWidth);
-    int y = (int)(quad->boundary.center.y - quad->boundary.halfHeight);
-    int width = (int)(quad->boundary.halfWidth * 2);
-    int height = (int)(quad->boundary.halfHeight * 2);
-
-    // Draw a filled black rectangle to erase this quad's boundary
-    XDrawRectangle(win->display, win->backBuffer, win->gc, x, y, width, height);
-    
-    // Recursively erase child quads
-    if (quad->northWest) eraseQuadTree(win, quad->northWest);
-    if (quad->northEast) eraseQuadTree(win, quad->northEast);
-    if (quad->southWest) eraseQuadTree(win, quad->southWest);
-    if (quad->southEast) eraseQuadTree(win, quad->southEast);
-}
\ No newline at end of file
+    stampQuadTree(cam, target, quad->northWest, color, size);
+    stampQuadTree(cam, target, quad->northEast, color, size);
+    stampQuadTree(cam, target, quad->southWest, color, size);
+    stampQuadTree(cam, target, quad->southEast, color, size);
+}
+
+void drawQuadTreePoints(VWindow* win, QuadTree* quad, unsigned int color, int size)
+{
+    // Rendered at the scene's resolution, dots shrinking with it so they upscale back to about their size
+    Camera cam = sceneCamera(win);
+    stampQuadTree(&cam, win->scene, quad, color, (int)(size * win->renderScale));
+    markSceneDirty(win);
+}
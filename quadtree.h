@@ -8,7 +8,12 @@
 #include "window.h"
 #include "vec2.h"
 
+// Points held by a leaf before it splits; override with -DQUAD_NODE_CAPACITY=n
+#ifndef QUAD_NODE_CAPACITY
 #define QUAD_NODE_CAPACITY 6
+#endif
+#define QUAD_LOD_PIXELS 1.0f          // nodes projecting smaller than this are not descended into
+#define QUAD_OVERLAY_LOD_PIXELS 2.0f  // below this, cell outlines merge into a solid block
 
 typedef struct QuadTree QuadTree;
 
@@ -37,12 +42,36 @@ typedef struct QuadTree
 void freeQuadTree(QuadTree* quad);
 void subdivide(QuadTree* quad);
 
-//bool intersectsAABB(AABB other);
+bool containsPoint(AABB box, vec2 p);
+bool intersectsAABB(AABB a, AABB b);
 bool insert(QuadTree* quad, vec2 p);
+// Copies up to maxFound points inside range into found; returns how many were copied
+int queryRange(QuadTree* quad, AABB range, vec2* found, int maxFound);
+// Closest stored point to target; returns false when the tree is empty
+bool nearestPoint(QuadTree* quad, vec2 target, vec2* nearest);
 
 QuadTree* constructQuadTree(vec2 center, float halfwidth, float halfheight);
 AABB constructBoundingBox(vec2 center, float halfwidth, float halfheight);
+
+// Projects a box through the camera into screen x, y, w, h; returns false when it is entirely off screen
+bool projectAABB(const Camera* cam, const AABB* boundary, float* x, float* y, float* w, float* h);
+
+// Outlines a screen-space rectangle that may extend far past the surface
+void strokeScreenRect(Surface* surface, float x, float y, float w, float h, unsigned int color);
+
+// Per-node steps of the drawing walks, shared by QuadTree and QuadSnapshot so only child and point
+// iteration differ. Each returns true when the walk should descend into the node's children.
+// strokeQuadNode outlines the node unless it is culled or smaller than QUAD_OVERLAY_LOD_PIXELS.
+bool strokeQuadNode(const Camera* cam, Surface* target, const AABB* boundary, unsigned int color);
+// stampQuadNode culls the node, stamps it as one dot once it projects smaller than a dot,
+// and draws a leaf's points.
+bool stampQuadNode(const Camera* cam, Surface* target, const AABB* boundary, bool leaf,
+                   const vec2* points, int pointCount, unsigned int color, int size);
+
+// Drawing goes through win->camera: off-screen nodes are culled and sub-pixel nodes are not descended into.
+// Outlines go to the LAYER_QUADS layer and points to win->scene, which is presented through LAYER_POINTS.
 void drawQuadTree(VWindow* window, QuadTree* quad);
 void eraseQuadTree(VWindow* win, QuadTree* quad);
+void drawQuadTreePoints(VWindow* win, QuadTree* quad, unsigned int color, int size);
 
 #endif //QUADTREE_H
@@ -0,0 +1,351 @@
+#include "random.h"
+#include "define.h"
+
+#include <math.h>
+#include <stdatomic.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define PI_F 3.14159265f
+
+// Threads that never call rngSeed get consecutive streams of this seed.
+#define RNG_DEFAULT_SEED 0x5EEDC0DEull
+
+static _Thread_local Rng threadRng;
+static _Thread_local bool threadRngSeeded = false;
+static atomic_ullong nextStream = 0;
+
+static uint64_t splitmix64(uint64_t* x)
+{
+    uint64_t z = (*x += 0x9E3779B97F4A7C15ull);
+    z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ull;
+    z = (z ^ (z >> 27)) * 0x94D049BB133111EBull;
+    return z ^ (z >> 31);
+}
+
+void rngInit(Rng* rng, uint64_t seed, uint64_t stream)
+{
+    uint64_t x = seed ^ (stream * 0xD1B54A32D192ED03ull);
+    for (int lane = 0; lane < RNG_LANES; lane++) {
+        uint64_t a = splitmix64(&x);
+        uint64_t b = splitmix64(&x);
+        rng->s[0][lane] = (uint32_t)a;
+        rng->s[1][lane] = (uint32_t)(a >> 32);
+        rng->s[2][lane] = (uint32_t)b;
+        rng->s[3][lane] = (uint32_t)(b >> 32) | 1u; // never all zero
+    }
+    rng->bufferPos = RNG_LANES;
+}
+
+void rngSeed(uint64_t seed)
+{
+    rngSeedStream(seed, 0);
+}
+
+void rngSeedStream(uint64_t seed, uint64_t stream)
+{
+    rngInit(&threadRng, seed, stream);
+    threadRngSeeded = true;
+}
+
+Rng* rngThread(void)
+{
+    if (!threadRngSeeded) {
+        rngSeedStream(RNG_DEFAULT_SEED, atomic_fetch_add(&nextStream, 1));
+    }
+    return &threadRng;
+}
+
+// Advances every lane once (xoshiro128+). Lanes are independent, so this vectorizes.
+static inline void rngStep(Rng* rng, uint32_t out[RNG_LANES])
+{
+    for (int i = 0; i < RNG_LANES; i++) {
+        uint32_t s0 = rng->s[0][i];
+        uint32_t s1 = rng->s[1][i];
+        uint32_t s2 = rng->s[2][i];
+        uint32_t s3 = rng->s[3][i];
+        uint32_t t = s1 << 9;
+
+        out[i] = s0 + s3;
+
+        s2 ^= s0;
+        s3 ^= s1;
+        s1 ^= s2;
+        s0 ^= s3;
+        s2 ^= t;
+        s3 = (s3 << 11) | (s3 >> 21);
+
+        rng->s[0][i] = s0;
+        rng->s[1][i] = s1;
+        rng->s[2][i] = s2;
+        rng->s[3][i] = s3;
+    }
+}
+
+// One block of RNG_LANES floats in [0, 1), built from the top 24 bits of each output.
+static inline void rngUnitBlock(Rng* rng, float out[RNG_LANES])
+{
+    uint32_t bits[RNG_LANES];
+    rngStep(rng, bits);
+    for (int i = 0; i < RNG_LANES; i++) {
+        out[i] = (float)(int32_t)(bits[i] >> 8) * 0x1.0p-24f;
+    }
+}
+
+uint32_t rngNext(Rng* rng)
+{
+    if (rng->bufferPos >= RNG_LANES) {
+        rngStep(rng, rng->buffer);
+        rng->bufferPos = 0;
+    }
+    return rng->buffer[rng->bufferPos++];
+}
+
+float rngFloat(Rng* rng)
+{
+    return (float)(int32_t)(rngNext(rng) >> 8) * 0x1.0p-24f;
+}
+
+/*
+ * Branch-free approximations used by the bulk kernels in place of libm calls,
+ * which would otherwise stop the loops from vectorizing. Relative error is
+ * around 1e-5, plenty for generating workloads. The selects below only turn
+ * into vector blends with -fno-trapping-math (see build.sh).
+ */
+static inline float fastLog2(float x)
+{
+    uint32_t bits;
+    memcpy(&bits, &x, sizeof(bits));
+    float e = (float)((int32_t)((bits >> 23) & 0xFF) - 127);
+    bits = (bits & 0x007FFFFF) | 0x3F800000;
+    float m;
+    memcpy(&m, &bits, sizeof(m));
+
+    // log2(m) = 2/ln2 * atanh((m - 1) / (m + 1)), m in [1, 2)
+    float t = (m - 1.0f) / (m + 1.0f);
+    float t2 = t * t;
+    return e + t * (2.88539008f + t2 * (0.96179669f + t2 * (0.57707802f + t2 * 0.41219858f)));
+}
+
+static inline float fastExp2(float x)
+{
+    x = x < -126.0f ? -126.0f : (x > 127.0f ? 127.0f : x);
+    int32_t i = (int32_t)x;
+    float y = (x - (float)i) * 0.69314718f;
+
+    float p = 1.0f + y * (1.0f + y * (0.5f + y * (1.0f / 6.0f + y * (1.0f / 24.0f +
+              y * (1.0f / 120.0f + y * (1.0f / 720.0f))))));
+
+    uint32_t bits = (uint32_t)(i + 127) << 23;
+    float scale;
+    memcpy(&scale, &bits, sizeof(scale));
+    return p * scale;
+}
+
+// u^power for u in [0, 1) and power > 0
+static inline float fastPow01(float u, float power)
+{
+    return fastExp2(power * fastLog2(u));
+}
+
+// x in [-pi, pi]
+static inline float fastSin(float x)
+{
+    x = x > 0.5f * PI_F ? PI_F - x : (x < -0.5f * PI_F ? -PI_F - x : x);
+    float x2 = x * x;
+    return x * (1.0f + x2 * (-1.0f / 6.0f + x2 * (1.0f / 120.0f + x2 * (-1.0f / 5040.0f + x2 * (1.0f / 362880.0f)))));
+}
+
+// Standard normal pair from two uniforms (Box-Muller), written out per lane.
+static inline void gaussianBlock(Rng* rng, float gx[RNG_LANES], float gy[RNG_LANES])
+{
+    float u[RNG_LANES], v[RNG_LANES];
+    rngUnitBlock(rng, u);
+    rngUnitBlock(rng, v);
+    for (int i = 0; i < RNG_LANES; i++) {
+        float r2 = -2.0f * 0.69314718f * fastLog2(1.0f - u[i]);  // -2 ln u, u in (0, 1]
+        float r = r2 > 0.0f ? fastExp2(0.5f * fastLog2(r2)) : 0.0f;
+        float a = (v[i] - 0.5f) * 2.0f * PI_F;
+        float b = a + 0.5f * PI_F;
+        b = b > PI_F ? b - 2.0f * PI_F : b;
+        gx[i] = r * fastSin(b);  // cos(a)
+        gy[i] = r * fastSin(a);
+    }
+}
+
+float frand(float max)
+{
+    return rngFloat(rngThread()) * max;
+}
+
+float frand_clustered(float max, float power)
+{
+    ASSERT(power > 0.0f);
+    return fastPow01(rngFloat(rngThread()), power) * max;
+}
+
+void randUniform(vec2* out, int count, float width, float height)
+{
+    Rng* rng = rngThread();
+    float ux[RNG_LANES], uy[RNG_LANES];
+    int i = 0;
+
+    for (; i + RNG_LANES <= count; i += RNG_LANES) {
+        rngUnitBlock(rng, ux);
+        rngUnitBlock(rng, uy);
+        for (int j = 0; j < RNG_LANES; j++) {
+            out[i + j].x = ux[j] * width;
+            out[i + j].y = uy[j] * height;
+        }
+    }
+    for (; i < count; i++) {
+        out[i].x = rngFloat(rng) * width;
+        out[i].y = rngFloat(rng) * height;
+    }
+}
+
+void randClustered(vec2* out, int count, float width, float height, float powerX, float powerY)
+{
+    ASSERT(powerX > 0.0f && powerY > 0.0f);
+    Rng* rng = rngThread();
+    float ux[RNG_LANES], uy[RNG_LANES];
+    int i = 0;
+
+    for (; i + RNG_LANES <= count; i += RNG_LANES) {
+        rngUnitBlock(rng, ux);
+        rngUnitBlock(rng, uy);
+        for (int j = 0; j < RNG_LANES; j++) {
+            out[i + j].x = fastPow01(ux[j], powerX) * width;
+            out[i + j].y = fastPow01(uy[j], powerY) * height;
+        }
+    }
+    for (; i < count; i++) {
+        out[i].x = fastPow01(rngFloat(rng), powerX) * width;
+        out[i].y = fastPow01(rngFloat(rng), powerY) * height;
+    }
+}
+
+void randGaussianClusters(vec2* out, int count, float width, float height, int clusters, float sigma)
+{
+    ASSERT(clusters > 0);
+    Rng* rng = rngThread();
+
+    vec2* centers = (vec2*)malloc(clusters * sizeof(vec2));
+    if (!centers) {
+        fprintf(stderr, "Failed to allocate cluster centers\n");
+        return;
+    }
+    randUniform(centers, clusters, width, height);
+
+    float gx[RNG_LANES], gy[RNG_LANES], pick[RNG_LANES];
+    for (int i = 0; i < count; i += RNG_LANES) {
+        gaussianBlock(rng, gx, gy);
+        rngUnitBlock(rng, pick);
+
+        int n = count - i < RNG_LANES ? count - i : RNG_LANES;
+        for (int j = 0; j < n; j++) {
+            vec2 c = centers[(int)(pick[j] * clusters)];
+            float x = c.x + gx[j] * sigma;
+            float y = c.y + gy[j] * sigma;
+            // Reflect off the borders rather than clamping, which would pile points up on them
+            x = x < 0.0f ? -x : (x > width ? 2.0f * width - x : x);
+            y = y < 0.0f ? -y : (y > height ? 2.0f * height - y : y);
+            out[i + j].x = x < 0.0f ? 0.0f : (x > width ? width : x);
+            out[i + j].y = y < 0.0f ? 0.0f : (y > height ? height : y);
+        }
+    }
+    free(centers);
+}
+
+// Bridson's algorithm: grid cells of radius/sqrt(2) hold at most one sample each.
+#define POISSON_ATTEMPTS (4 * RNG_LANES)
+
+int randPoissonDisc(vec2* out, int maxCount, float width, float height, float radius)
+{
+    if (maxCount <= 0 || radius <= 0.0f) return 0;
+
+    Rng* rng = rngThread();
+    float cell = radius / sqrtf(2.0f);
+    int gridW = (int)ceilf(width / cell);
+    int gridH = (int)ceilf(height / cell);
+    if (gridW < 1) gridW = 1;
+    if (gridH < 1) gridH = 1;
+
+    int* grid = (int*)malloc((size_t)gridW * gridH * sizeof(int));
+    int* active = (int*)malloc(maxCount * sizeof(int));
+    if (!grid || !active) {
+        fprintf(stderr, "Failed to allocate Poisson disc grid\n");
+        free(grid);
+        free(active);
+        return 0;
+    }
+    memset(grid, 0xFF, (size_t)gridW * gridH * sizeof(int));  // all -1
+
+    float r2 = radius * radius;
+    int count = 0;
+    int activeCount = 0;
+
+    vec2 first = {rngFloat(rng) * width, rngFloat(rng) * height};
+    out[count] = first;
+    grid[(int)(first.y / cell) * gridW + (int)(first.x / cell)] = count;
+    active[activeCount++] = count++;
+
+    float dx[POISSON_ATTEMPTS], dy[POISSON_ATTEMPTS];
+    while (activeCount > 0 && count < maxCount) {
+        int slot = (int)(rngFloat(rng) * activeCount);
+        vec2 base = out[active[slot]];
+
+        // Candidate offsets uniformly distributed over the annulus [r, 2r]
+        for (int k = 0; k < POISSON_ATTEMPTS; k += RNG_LANES) {
+            float u[RNG_LANES], v[RNG_LANES];
+            rngUnitBlock(rng, u);
+            rngUnitBlock(rng, v);
+            for (int j = 0; j < RNG_LANES; j++) {
+                float d = radius * fastExp2(0.5f * fastLog2(1.0f + 3.0f * u[j]));
+                float a = (v[j] - 0.5f) * 2.0f * PI_F;
+                float b = a + 0.5f * PI_F;
+                b = b > PI_F ? b - 2.0f * PI_F : b;
+                dx[k + j] = d * fastSin(b);
+                dy[k + j] = d * fastSin(a);
+            }
+        }
+
+        bool found = false;
+        for (int k = 0; k < POISSON_ATTEMPTS && !found; k++) {
+            vec2 c = {base.x + dx[k], base.y + dy[k]};
+            if (c.x < 0.0f || c.x >= width || c.y < 0.0f || c.y >= height) continue;
+
+            int gx = (int)(c.x / cell);
+            int gy = (int)(c.y / cell);
+            bool clear = true;
+            for (int y = gy - 2; y <= gy + 2 && clear; y++) {
+                if (y < 0 || y >= gridH) continue;
+                for (int x = gx - 2; x <= gx + 2; x++) {
+                    if (x < 0 || x >= gridW) continue;
+                    int other = grid[y * gridW + x];
+                    if (other < 0) continue;
+                    float ox = out[other].x - c.x;
+                    float oy = out[other].y - c.y;
+                    if (ox * ox + oy * oy < r2) { clear = false; break; }
+                }
+            }
+
+            if (clear) {
+                out[count] = c;
+                grid[gy * gridW + gx] = count;
+                active[activeCount++] = count++;
+                found = true;
+            }
+        }
+
+        if (!found) {
+            active[slot] = active[--activeCount];
+        }
+    }
+
+    free(grid);
+    free(active);
+    return count;
+}
@@ -1,25 +1,38 @@
 #ifndef RANDOM_H
 #define RANDOM_H
 
-#include <stdlib.h>
-#include <stdio.h>
-#include <time.h>
-#include <math.h>
+#include <stdint.h>
 
+#include "vec2.h"
 
-float frand(float max)
-{
-    float scale = (float)rand() / (float) RAND_MAX; /* [0, 1.0] */
-    float value = scale * max;
-    return value;        /* [min, max] */
-}
+// Number of independent xoshiro128+ streams stepped side by side.
+// The bulk generators advance all lanes at once so the loops vectorize.
+#define RNG_LANES 8
 
-float frand_clustered(float max, float power)
+typedef struct Rng
 {
-    float scale = (float)rand() / (float) RAND_MAX; /* [0, 1.0] */
-    float value = powf(scale, power) * max;
-    return value;        /* [0, max] */
-}
+    uint32_t s[4][RNG_LANES];   // state word major, lane minor
+    uint32_t buffer[RNG_LANES]; // outputs handed out one by one to scalar callers
+    int bufferPos;
+} Rng;
 
-#endif //RANDOM_H
+// Seeding is reproducible: the same (seed, stream) pair always yields the same sequence.
+void rngInit(Rng* rng, uint64_t seed, uint64_t stream);
+void rngSeed(uint64_t seed);                    // seeds the calling thread's generator
+void rngSeedStream(uint64_t seed, uint64_t stream);
+Rng* rngThread(void);                           // calling thread's generator, lazily seeded
+
+uint32_t rngNext(Rng* rng);
+float rngFloat(Rng* rng);                       // [0, 1)
 
+float frand(float max);                         // [0, max)
+float frand_clustered(float max, float power);  // [0, max), biased toward 0 when power > 1
+
+// Bulk generators, all drawing from the calling thread's generator.
+void randUniform(vec2* out, int count, float width, float height);
+void randClustered(vec2* out, int count, float width, float height, float powerX, float powerY);
+void randGaussianClusters(vec2* out, int count, float width, float height, int clusters, float sigma);
+// Returns the number of points written, at most maxCount.
+int randPoissonDisc(vec2* out, int maxCount, float width, float height, float radius);
+
+#endif //RANDOM_H
@@ -0,0 +1,303 @@
+#include "raster.h"
+
+#include <math.h>
+
+typedef struct Edge
+{
+    float x;        // intersection with the current sample line
+    float dxdy;
+    int top;        // first sample line crossed
+    int bottom;     // one past the last
+    int winding;    // +1 going down, -1 going up
+} Edge;
+
+static int compareEdgeTop(const void* a, const void* b)
+{
+    return ((const Edge*)a)->top - ((const Edge*)b)->top;
+}
+
+// Coverage accumulated for one pixel row while antialiasing
+typedef struct CoverageRow
+{
+    float* partial;  // fractional coverage at span ends
+    float* full;     // +w / -w where runs of fully covered pixels start / stop
+    int minX, maxX;
+} CoverageRow;
+
+static void accumulateSpan(CoverageRow* row, float xa, float xb, float weight, int width)
+{
+    if (xa < 0.0f) xa = 0.0f;
+    if (xb > (float)width) xb = (float)width;
+    if (xa >= xb) return;
+
+    int ia = (int)xa;
+    int ib = (int)xb;
+    if (ia < row->minX) row->minX = ia;
+    if (ib > row->maxX) row->maxX = ib;
+
+    if (ia == ib) {
+        row->partial[ia] += (xb - xa) * weight;
+        return;
+    }
+    row->partial[ia] += ((float)(ia + 1) - xa) * weight;
+    row->full[ia + 1] += weight;
+    row->full[ib] -= weight;
+    row->partial[ib] += (xb - (float)ib) * weight;
+}
+
+// On failure the row is left empty and the caller draws without antialiasing
+static bool allocCoverageRow(CoverageRow* row, int width)
+{
+    row->partial = (float*)calloc(width + 2, sizeof(float));
+    row->full = (float*)calloc(width + 2, sizeof(float));
+    row->minX = width;
+    row->maxX = -1;
+    if (row->partial && row->full) return true;
+    free(row->partial);
+    free(row->full);
+    row->partial = row->full = NULL;
+    return false;
+}
+
+// Emits the accumulated row as runs of equal coverage and resets it
+static void flushCoverageRow(Surface* surface, CoverageRow* row, int y, unsigned int color)
+{
+    if (row->minX > row->maxX) return;
+
+    float run = 0.0f;
+    int spanStart = row->minX;
+    unsigned int spanCoverage = 0;
+    for (int x = row->minX; x <= row->maxX + 1; x++) {
+        unsigned int coverage = 0;
+        if (x <= row->maxX) {
+            run += row->full[x];
+            float c = run + row->partial[x];
+            coverage = c >= 1.0f ? 255 : (c <= 0.0f ? 0 : (unsigned int)(c * 255.0f + 0.5f));
+            row->full[x] = 0.0f;
+            row->partial[x] = 0.0f;
+        }
+        if (coverage != spanCoverage || x > row->maxX) {
+            blendSpan(surface, y, spanStart, x, color, spanCoverage);
+            spanStart = x;
+            spanCoverage = coverage;
+        }
+    }
+    row->full[row->maxX + 1] = 0.0f;
+    row->minX = surface->width;
+    row->maxX = -1;
+}
+
+void fillPolygon(Surface* surface, const vec2* points, int count, unsigned int color, FillRule rule, bool antialias)
+{
+    if (count < 3) return;
+
+    // Without coverage rows fall back to aliased spans; decided before the edges are scaled to sub-rows
+    CoverageRow row = {NULL, NULL, surface->width, -1};
+    if (antialias) antialias = allocCoverageRow(&row, surface->width);
+
+    // Sample lines sit at the centers of rows (or of sub-rows when antialiasing)
+    int scale = antialias ? RASTER_AA_SUBSAMPLES : 1;
+    int lineMin = 0;
+    int lineMax = surface->height * scale;
+
+    Edge* edges = (Edge*)malloc(count * sizeof(Edge));
+    int* active = (int*)malloc(count * sizeof(int));
+    if (!edges || !active) {
+        free(edges);
+        free(active);
+        free(row.partial);
+        free(row.full);
+        return;
+    }
+
+    // Edge table, sorted by first sample line
+    int edgeCount = 0;
+    for (int i = 0; i < count; i++) {
+        vec2 a = points[i];
+        vec2 b = points[(i + 1) % count];
+        int winding = 1;
+        if (a.y == b.y) continue;
+        if (a.y > b.y) { vec2 t = a; a = b; b = t; winding = -1; }
+
+        float ya = a.y * scale, yb = b.y * scale;
+        Edge e;
+        e.top = (int)ceilf(ya - 0.5f);
+        e.bottom = (int)ceilf(yb - 0.5f);
+        if (e.top < lineMin) e.top = lineMin;
+        if (e.bottom > lineMax) e.bottom = lineMax;
+        if (e.top >= e.bottom) continue;
+        e.dxdy = (b.x - a.x) / (yb - ya);
+        e.x = a.x + ((float)e.top + 0.5f - ya) * e.dxdy;
+        e.winding = winding;
+        edges[edgeCount++] = e;
+    }
+    qsort(edges, edgeCount, sizeof(Edge), compareEdgeTop);
+
+    float weight = 1.0f / (float)scale;
+    int nextEdge = 0;
+    int activeCount = 0;
+    int line = edgeCount > 0 ? edges[0].top : lineMax;
+    int currentRow = line / scale;
+
+    while (line < lineMax && (nextEdge < edgeCount || activeCount > 0)) {
+        int y = line / scale;
+        if (antialias && y != currentRow) {
+            flushCoverageRow(surface, &row, currentRow, color);
+            currentRow = y;
+        }
+
+        // Active edge table: add edges starting here, drop the ones that ended
+        while (nextEdge < edgeCount && edges[nextEdge].top == line) {
+            active[activeCount++] = nextEdge++;
+        }
+        int kept = 0;
+        for (int i = 0; i < activeCount; i++) {
+            if (edges[active[i]].bottom > line) active[kept++] = active[i];
+        }
+        activeCount = kept;
+
+        // Keep active edges ordered by x; they are nearly sorted from the previous line
+        for (int i = 1; i < activeCount; i++) {
+            int e = active[i];
+            int j = i - 1;
+            while (j >= 0 && edges[active[j]].x > edges[e].x) {
+                active[j + 1] = active[j];
+                j--;
+            }
+            active[j + 1] = e;
+        }
+
+        int winding = 0;
+        for (int i = 0; i + 1 < activeCount; i++) {
+            winding += rule == FILL_EVEN_ODD ? 1 : edges[active[i]].winding;
+            bool inside = rule == FILL_EVEN_ODD ? (winding & 1) : winding != 0;
+            if (!inside) continue;
+
+            float xa = edges[active[i]].x;
+            float xb = edges[active[i + 1]].x;
+            if (antialias) {
+                accumulateSpan(&row, xa, xb, weight, surface->width);
+            } else {
+                fillSpan(surface, y, (int)ceilf(xa - 0.5f), (int)ceilf(xb - 0.5f), color);
+            }
+        }
+
+        for (int i = 0; i < activeCount; i++) {
+            edges[active[i]].x += edges[active[i]].dxdy;
+        }
+
+        // Skip empty stretches straight to the next edge
+        line++;
+        if (activeCount == 0 && nextEdge < edgeCount && edges[nextEdge].top > line) {
+            line = edges[nextEdge].top;
+        }
+    }
+    if (antialias) flushCoverageRow(surface, &row, currentRow, color);
+
+    free(row.partial);
+    free(row.full);
+    free(edges);
+    free(active);
+}
+
+/*
+ * Circles, ellipses and rounded rectangles are symmetric about their center,
+ * so each sample line is one span found analytically. Antialiasing samples
+ * RASTER_SHAPE_SUBSAMPLES sub-rows per row and accumulates their spans like
+ * fillPolygon, which keeps coverage exact horizontally for any eccentricity.
+ */
+typedef enum ShapeType
+{
+    SHAPE_ELLIPSE,
+    SHAPE_ROUNDED_RECT
+} ShapeType;
+
+typedef struct Shape
+{
+    ShapeType type;
+    vec2 center;
+    float halfWidth;
+    float halfHeight;
+    float radius;   // corner radius of a rounded rect
+} Shape;
+
+// Half width of the shape at vertical offset dy from the center; < 0 when the line misses
+static float shapeHalfExtent(const Shape* shape, float dy)
+{
+    float hw = shape->halfWidth;
+    float hh = shape->halfHeight;
+    dy = fabsf(dy);
+    if (dy > hh) return -1.0f;
+
+    if (shape->type == SHAPE_ELLIPSE) {
+        float t = dy / hh;
+        return hw * sqrtf(1.0f - t * t);
+    }
+
+    float r = shape->radius;
+    if (dy <= hh - r) return hw;
+    float cy = dy - (hh - r);
+    return (hw - r) + sqrtf(fmaxf(r * r - cy * cy, 0.0f));
+}
+
+static void fillShape(Surface* surface, const Shape* shape, unsigned int color, bool antialias)
+{
+    CoverageRow row = {NULL, NULL, surface->width, -1};
+    if (antialias) antialias = allocCoverageRow(&row, surface->width);
+
+    // Aliased shapes cover the pixel centers in [top, bottom) x [left, right), like fillPolygon
+    int yStart, yEnd;
+    if (antialias) {
+        yStart = (int)floorf(shape->center.y - shape->halfHeight);
+        yEnd = (int)ceilf(shape->center.y + shape->halfHeight);
+    } else {
+        yStart = (int)ceilf(shape->center.y - shape->halfHeight - 0.5f);
+        yEnd = (int)ceilf(shape->center.y + shape->halfHeight - 0.5f);
+    }
+    if (yStart < 0) yStart = 0;
+    if (yEnd > surface->height) yEnd = surface->height;
+
+    float cx = shape->center.x;
+    float weight = 1.0f / RASTER_SHAPE_SUBSAMPLES;
+    for (int y = yStart; y < yEnd; y++) {
+        if (!antialias) {
+            float extent = shapeHalfExtent(shape, (float)y + 0.5f - shape->center.y);
+            if (extent < 0.0f) continue;
+            fillSpan(surface, y, (int)ceilf(cx - extent - 0.5f), (int)ceilf(cx + extent - 0.5f), color);
+            continue;
+        }
+
+        for (int s = 0; s < RASTER_SHAPE_SUBSAMPLES; s++) {
+            float extent = shapeHalfExtent(shape, (float)y + ((float)s + 0.5f) * weight - shape->center.y);
+            if (extent < 0.0f) continue;
+            accumulateSpan(&row, cx - extent, cx + extent, weight, surface->width);
+        }
+        flushCoverageRow(surface, &row, y, color);
+    }
+
+    free(row.partial);
+    free(row.full);
+}
+
+void fillCircle(Surface* surface, vec2 center, float radius, unsigned int color, bool antialias)
+{
+    fillEllipse(surface, center, radius, radius, color, antialias);
+}
+
+void fillEllipse(Surface* surface, vec2 center, float radiusX, float radiusY, unsigned int color, bool antialias)
+{
+    if (radiusX <= 0.0f || radiusY <= 0.0f) return;
+    Shape shape = {SHAPE_ELLIPSE, center, radiusX, radiusY, 0.0f};
+    fillShape(surface, &shape, color, antialias);
+}
+
+void fillRoundedRect(Surface* surface, float x, float y, float w, float h, float radius, unsigned int color, bool antialias)
+{
+    if (w <= 0.0f || h <= 0.0f) return;
+    float maxRadius = 0.5f * fminf(w, h);
+    radius = radius < 0.0f ? 0.0f : (radius > maxRadius ? maxRadius : radius);
+
+    vec2 center = {x + w * 0.5f, y + h * 0.5f};
+    Shape shape = {SHAPE_ROUNDED_RECT, center, w * 0.5f, h * 0.5f, radius};
+    fillShape(surface, &shape, color, antialias);
+}
@@ -0,0 +1,34 @@
+#ifndef RASTER_H
+#define RASTER_H
+
+#include <stdbool.h>
+
+#include "surface.h"
+#include "vec2.h"
+
+/*
+ * Filled shapes rasterized a scanline at a time and emitted as spans
+ * (fillSpan / blendSpan) rather than individual pixels. Coordinates are in
+ * surface pixels with pixel (x, y) covering [x, x + 1) x [y, y + 1); without
+ * antialiasing a pixel is filled when its center is inside the shape.
+ */
+
+// Polygon antialiasing samples this many sub-scanlines per row, with exact horizontal coverage
+#define RASTER_AA_SUBSAMPLES 4
+// Curved outlines need finer sub-scanlines to follow their slope near the top and bottom
+#define RASTER_SHAPE_SUBSAMPLES 16
+
+typedef enum FillRule
+{
+    FILL_EVEN_ODD,
+    FILL_NONZERO
+} FillRule;
+
+// Convex, concave or self-intersecting; the last point connects back to the first
+void fillPolygon(Surface* surface, const vec2* points, int count, unsigned int color, FillRule rule, bool antialias);
+
+void fillCircle(Surface* surface, vec2 center, float radius, unsigned int color, bool antialias);
+void fillEllipse(Surface* surface, vec2 center, float radiusX, float radiusY, unsigned int color, bool antialias);
+void fillRoundedRect(Surface* surface, float x, float y, float w, float h, float radius, unsigned int color, bool antialias);
+
+#endif //RASTER_H
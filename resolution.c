@@ -0,0 +1,51 @@
+#include "resolution.h"
+
+#include <math.h>
+
+#define RESOLUTION_SMOOTHING 0.25  // weight of the newest frame in frameMs
+
+static float snapScale(float scale)
+{
+    scale = floorf(scale / RESOLUTION_SCALE_STEP) * RESOLUTION_SCALE_STEP;
+    if (scale < RESOLUTION_MIN_SCALE) scale = RESOLUTION_MIN_SCALE;
+    if (scale > 1.0f) scale = 1.0f;
+    return scale;
+}
+
+void initResolutionController(ResolutionController* rc)
+{
+    rc->scale = 1.0f;
+    rc->frameMs = 0.0;
+    rc->frames = 0;
+    rc->idleFrames = 0;
+}
+
+bool updateResolutionScale(ResolutionController* rc, double frameMs)
+{
+    rc->frameMs = rc->frames == 0 ? frameMs : rc->frameMs + (frameMs - rc->frameMs) * RESOLUTION_SMOOTHING;
+    rc->frames++;
+    rc->idleFrames = 0;
+
+    float scale = rc->scale;
+    if (rc->frames >= RESOLUTION_DOWN_FRAMES && rc->frameMs > FRAME_BUDGET_MS) {
+        // At least one step down, further if the overshoot calls for it
+        float fit = rc->scale * (float)sqrt(FRAME_BUDGET_MS * RESOLUTION_MARGIN / rc->frameMs);
+        scale = snapScale(fminf(fit, rc->scale - RESOLUTION_SCALE_STEP));
+    } else if (rc->frames >= RESOLUTION_UP_FRAMES && rc->scale < 1.0f) {
+        float next = snapScale(rc->scale + RESOLUTION_SCALE_STEP);
+        double ratio = (double)next / rc->scale;
+        if (rc->frameMs * ratio * ratio < FRAME_BUDGET_MS * RESOLUTION_MARGIN) scale = next;
+    }
+
+    if (scale == rc->scale) return false;
+    rc->scale = scale;
+    rc->frames = 0;
+    return true;
+}
+
+bool idleResolutionScale(ResolutionController* rc)
+{
+    if (++rc->idleFrames < RESOLUTION_IDLE_FRAMES || rc->scale >= 1.0f) return false;
+    initResolutionController(rc);
+    return true;
+}
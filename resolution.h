@@ -0,0 +1,35 @@
+#ifndef RESOLUTION_H
+#define RESOLUTION_H
+
+#include <stdbool.h>
+
+#define FRAME_BUDGET_MS 16.6
+#define RESOLUTION_MIN_SCALE 0.25f
+#define RESOLUTION_SCALE_STEP 0.0625f   // scales are multiples of 1/16
+#define RESOLUTION_DOWN_FRAMES 3        // frames over budget before dropping resolution
+#define RESOLUTION_UP_FRAMES 30         // frames measured at a scale before climbing back
+#define RESOLUTION_MARGIN 0.85          // climb only if the next step is predicted to fit this share of the budget
+#define RESOLUTION_IDLE_FRAMES 30       // frames without a redraw before a reduced scale returns to full
+
+/*
+ * Picks the scale the scene is rendered at so that frames fit FRAME_BUDGET_MS.
+ * Cost is assumed to grow with the pixel count, i.e. with scale squared: an
+ * over-budget frame drops straight to the scale predicted to fit, and the
+ * scale climbs back one step at a time once the next step is predicted to fit.
+ */
+typedef struct ResolutionController
+{
+    float scale;
+    double frameMs;     // smoothed frame time measured at this scale
+    int frames;         // frames measured since the scale last changed
+    int idleFrames;     // frames in a row that did not redraw the scene
+} ResolutionController;
+
+void initResolutionController(ResolutionController* rc);
+// Feeds the work time of a frame that redrew the scene; returns true when rc->scale changed
+bool updateResolutionScale(ResolutionController* rc, double frameMs);
+// Counts a frame that did not redraw; once the view has been still long enough a reduced
+// scale goes back to full, since nothing is measured to climb on. Returns true when rc->scale changed
+bool idleResolutionScale(ResolutionController* rc);
+
+#endif //RESOLUTION_H
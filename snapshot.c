@@ -0,0 +1,297 @@
+#include "snapshot.h"
+#include "define.h"
+
+#include <fcntl.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+// Nodes start on a cache line boundary after the header
+#define QUAD_SNAPSHOT_NODES_OFFSET 64
+// Leaf capacities past this are not something a QuadTree build produces
+#define QUAD_SNAPSHOT_MAX_NODE_CAPACITY 65536
+// A float box halved this many times has collapsed to nothing, so no real tree is deeper
+#define QUAD_SNAPSHOT_MAX_DEPTH 280
+
+typedef struct SnapshotWriter
+{
+    QuadSnapshotNode* nodes;
+    vec2* points;
+    uint32_t nodeCount;
+    uint32_t pointCount;
+} SnapshotWriter;
+
+static void countQuadTree(QuadTree* quad, uint32_t* nodes, uint32_t* points)
+{
+    (*nodes)++;
+    if (quad->northWest == NULL) {
+        *points += quad->pointCount;
+        return;
+    }
+    countQuadTree(quad->northWest, nodes, points);
+    countQuadTree(quad->northEast, nodes, points);
+    countQuadTree(quad->southWest, nodes, points);
+    countQuadTree(quad->southEast, nodes, points);
+}
+
+static void flattenQuadTree(SnapshotWriter* writer, QuadTree* quad, uint32_t index)
+{
+    QuadSnapshotNode* node = &writer->nodes[index];
+    node->boundary = quad->boundary;
+    node->firstPoint = writer->pointCount;
+
+    if (quad->northWest == NULL) {
+        node->firstChild = 0;
+        node->pointCount = quad->pointCount;
+        memcpy(&writer->points[writer->pointCount], quad->points, quad->pointCount * sizeof(vec2));
+        writer->pointCount += quad->pointCount;
+    } else {
+        // Reserve the four child slots before descending so siblings stay adjacent
+        uint32_t first = writer->nodeCount;
+        writer->nodeCount += 4;
+        node->firstChild = first;
+        node->pointCount = 0;
+        flattenQuadTree(writer, quad->northWest, first);
+        flattenQuadTree(writer, quad->northEast, first + 1);
+        flattenQuadTree(writer, quad->southWest, first + 2);
+        flattenQuadTree(writer, quad->southEast, first + 3);
+    }
+
+    node->subtreeCount = writer->pointCount - node->firstPoint;
+}
+
+bool saveQuadTreeSnapshot(QuadTree* quad, const char* path)
+{
+    if (!quad || !path) return false;
+
+    uint32_t nodeCount = 0, pointCount = 0;
+    countQuadTree(quad, &nodeCount, &pointCount);
+
+    SnapshotWriter writer;
+    writer.nodes = (QuadSnapshotNode*)calloc(nodeCount, sizeof(QuadSnapshotNode));
+    writer.points = (vec2*)malloc((pointCount > 0 ? pointCount : 1) * sizeof(vec2));
+    writer.nodeCount = 1;
+    writer.pointCount = 0;
+    if (!writer.nodes || !writer.points) {
+        fprintf(stderr, "Failed to allocate snapshot buffers\n");
+        free(writer.nodes);
+        free(writer.points);
+        return false;
+    }
+    flattenQuadTree(&writer, quad, 0);
+    ASSERT(writer.nodeCount == nodeCount && writer.pointCount == pointCount);
+
+    QuadSnapshotHeader header = {0};
+    header.magic = QUAD_SNAPSHOT_MAGIC;
+    header.version = QUAD_SNAPSHOT_VERSION;
+    header.nodeCount = nodeCount;
+    header.pointCount = pointCount;
+    header.nodeCapacity = QUAD_NODE_CAPACITY;
+    header.nodesOffset = QUAD_SNAPSHOT_NODES_OFFSET;
+    header.pointsOffset = header.nodesOffset + (uint64_t)nodeCount * sizeof(QuadSnapshotNode);
+
+    // Write next to the target and rename, so readers never map a half-written file
+    char tmpPath[4096];
+    snprintf(tmpPath, sizeof(tmpPath), "%s.tmp", path);
+    FILE* file = fopen(tmpPath, "wb");
+    if (!file) {
+        fprintf(stderr, "Cannot open %s for writing\n", tmpPath);
+        free(writer.nodes);
+        free(writer.points);
+        return false;
+    }
+
+    char padding[QUAD_SNAPSHOT_NODES_OFFSET] = {0};
+    bool ok = fwrite(&header, sizeof(header), 1, file) == 1 &&
+              fwrite(padding, QUAD_SNAPSHOT_NODES_OFFSET - sizeof(header), 1, file) == 1 &&
+              fwrite(writer.nodes, sizeof(QuadSnapshotNode), nodeCount, file) == nodeCount &&
+              fwrite(writer.points, sizeof(vec2), pointCount, file) == pointCount;
+    ok = fclose(file) == 0 && ok;
+    free(writer.nodes);
+    free(writer.points);
+
+    if (!ok || rename(tmpPath, path) != 0) {
+        fprintf(stderr, "Failed to write snapshot %s\n", path);
+        remove(tmpPath);
+        return false;
+    }
+    return true;
+}
+
+QuadSnapshot* openQuadSnapshot(const char* path)
+{
+    int fd = open(path, O_RDONLY);
+    if (fd < 0) {
+        fprintf(stderr, "Cannot open snapshot %s\n", path);
+        return NULL;
+    }
+
+    struct stat st;
+    if (fstat(fd, &st) != 0 || (size_t)st.st_size < QUAD_SNAPSHOT_NODES_OFFSET) {
+        fprintf(stderr, "Snapshot %s is too small\n", path);
+        close(fd);
+        return NULL;
+    }
+
+    size_t size = (size_t)st.st_size;
+    void* map = mmap(NULL, size, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);  // the mapping keeps the file alive
+    if (map == MAP_FAILED) {
+        fprintf(stderr, "Cannot map snapshot %s\n", path);
+        return NULL;
+    }
+
+    const QuadSnapshotHeader* header = (const QuadSnapshotHeader*)map;
+    const char* error = NULL;
+    if (header->magic == __builtin_bswap32(QUAD_SNAPSHOT_MAGIC)) {
+        error = "was written on a machine of the other endianness";
+    } else if (header->magic != QUAD_SNAPSHOT_MAGIC) {
+        error = "is not a quadtree snapshot";
+    } else if (header->version != QUAD_SNAPSHOT_VERSION) {
+        error = "has an unsupported version";
+    } else if (header->nodeCapacity == 0 || header->nodeCapacity > QUAD_SNAPSHOT_MAX_NODE_CAPACITY) {
+        error = "has an unsupported node capacity";
+    } else if (header->nodeCount == 0 ||
+               // Offsets are checked against the size before any arithmetic so nothing below can wrap
+               header->nodesOffset < sizeof(QuadSnapshotHeader) || header->nodesOffset > size ||
+               header->pointsOffset < sizeof(QuadSnapshotHeader) || header->pointsOffset > size ||
+               header->nodesOffset % sizeof(uint32_t) != 0 || header->pointsOffset % sizeof(float) != 0 ||
+               header->nodeCount > (size - header->nodesOffset) / sizeof(QuadSnapshotNode) ||
+               header->pointCount > (size - header->pointsOffset) / sizeof(vec2) ||
+               header->nodesOffset + (uint64_t)header->nodeCount * sizeof(QuadSnapshotNode) > header->pointsOffset) {
+        error = "is truncated or corrupt";
+    }
+    if (error) {
+        fprintf(stderr, "Snapshot %s %s\n", path, error);
+        munmap(map, size);
+        return NULL;
+    }
+
+    QuadSnapshot* snap = (QuadSnapshot*)malloc(sizeof(QuadSnapshot));
+    if (!snap) {
+        munmap(map, size);
+        return NULL;
+    }
+    snap->map = map;
+    snap->size = size;
+    snap->header = header;
+    snap->nodes = (const QuadSnapshotNode*)((const char*)map + header->nodesOffset);
+    snap->points = (const vec2*)((const char*)map + header->pointsOffset);
+    return snap;
+}
+
+void closeQuadSnapshot(QuadSnapshot* snap)
+{
+    if (snap == NULL) return;
+    munmap(snap->map, snap->size);
+    free(snap);
+}
+
+static bool containsAABB(AABB outer, AABB inner)
+{
+    return inner.center.x - inner.halfWidth >= outer.center.x - outer.halfWidth &&
+           inner.center.x + inner.halfWidth <= outer.center.x + outer.halfWidth &&
+           inner.center.y - inner.halfHeight >= outer.center.y - outer.halfHeight &&
+           inner.center.y + inner.halfHeight <= outer.center.y + outer.halfHeight;
+}
+
+// Nodes are only checked as the walks reach them; one whose indices leave the mapping reads as empty.
+// A real tree is no deeper than QUAD_SNAPSHOT_MAX_DEPTH and no walk visits a node twice, so walks also
+// stop at that depth or after nodeCount visits, cutting short links that form long chains or shared subtrees.
+static bool snapshotNodeValid(const QuadSnapshot* snap, uint32_t index, int depth, uint32_t* visitsLeft)
+{
+    const QuadSnapshotNode* node = &snap->nodes[index];
+    const QuadSnapshotHeader* header = snap->header;
+    if (depth > QUAD_SNAPSHOT_MAX_DEPTH || *visitsLeft == 0) return false;
+    (*visitsLeft)--;
+    if ((uint64_t)node->firstPoint + node->subtreeCount > header->pointCount) return false;
+    if (node->firstChild == 0) {
+        return node->pointCount <= node->subtreeCount && node->pointCount <= header->nodeCapacity;
+    }
+    // Children always come after their parent, which also rules out cycles
+    return node->firstChild > index && (uint64_t)node->firstChild + 4 <= header->nodeCount;
+}
+
+static int querySnapshotNode(const QuadSnapshot* snap, uint32_t index, int depth, uint32_t* visitsLeft,
+                             AABB range, vec2* found, int maxFound)
+{
+    const QuadSnapshotNode* node = &snap->nodes[index];
+    if (maxFound <= 0 || !snapshotNodeValid(snap, index, depth, visitsLeft) || node->subtreeCount == 0 || !intersectsAABB(node->boundary, range)) return 0;
+
+    const vec2* points = snap->points + node->firstPoint;
+
+    // The whole subtree is inside the range: its points are one contiguous run
+    if (containsAABB(range, node->boundary)) {
+        int count = node->subtreeCount < (uint32_t)maxFound ? (int)node->subtreeCount : maxFound;
+        memcpy(found, points, count * sizeof(vec2));
+        return count;
+    }
+
+    int count = 0;
+    if (node->firstChild == 0) {
+        for (uint32_t i = 0; i < node->pointCount && count < maxFound; i++) {
+            if (containsPoint(range, points[i])) {
+                found[count++] = points[i];
+            }
+        }
+        return count;
+    }
+
+    for (uint32_t child = node->firstChild; child < node->firstChild + 4; child++) {
+        count += querySnapshotNode(snap, child, depth + 1, visitsLeft, range, found + count, maxFound - count);
+    }
+    return count;
+}
+
+int querySnapshotRange(const QuadSnapshot* snap, AABB range, vec2* found, int maxFound)
+{
+    if (snap == NULL) return 0;
+    uint32_t visits = snap->header->nodeCount;
+    return querySnapshotNode(snap, 0, 0, &visits, range, found, maxFound);
+}
+
+static void strokeSnapshot(VWindow* win, const QuadSnapshot* snap, uint32_t index, int depth, uint32_t* visitsLeft,
+                           Surface* target)
+{
+    const QuadSnapshotNode* node = &snap->nodes[index];
+    if (!snapshotNodeValid(snap, index, depth, visitsLeft)) return;
+    if (!strokeQuadNode(&win->camera, target, &node->boundary, GREEN)) return;
+
+    if (node->firstChild != 0) {
+        for (uint32_t child = node->firstChild; child < node->firstChild + 4; child++) {
+            strokeSnapshot(win, snap, child, depth + 1, visitsLeft, target);
+        }
+    }
+}
+
+void drawSnapshot(VWindow* win, const QuadSnapshot* snap)
+{
+    if (snap == NULL) return;
+
+    uint32_t visits = snap->header->nodeCount;
+    strokeSnapshot(win, snap, 0, 0, &visits, win->layers[LAYER_QUADS].surface);
+    markLayerAllDirty(&win->layers[LAYER_QUADS]);
+}
+
+static void stampSnapshot(const Camera* cam, Surface* target, const QuadSnapshot* snap, uint32_t index, int depth,
+                          uint32_t* visitsLeft, unsigned int color, int size)
+{
+    const QuadSnapshotNode* node = &snap->nodes[index];
+    if (!snapshotNodeValid(snap, index, depth, visitsLeft) || node->subtreeCount == 0) return;
+    if (!stampQuadNode(cam, target, &node->boundary, node->firstChild == 0, snap->points + node->firstPoint,
+                       (int)node->pointCount, color, size)) return;
+
+    for (uint32_t child = node->firstChild; child < node->firstChild + 4; child++) {
+        stampSnapshot(cam, target, snap, child, depth + 1, visitsLeft, color, size);
+    }
+}
+
+void drawSnapshotPoints(VWindow* win, const QuadSnapshot* snap, unsigned int color, int size)
+{
+    if (snap == NULL) return;
+    Camera cam = sceneCamera(win);
+    uint32_t visits = snap->header->nodeCount;
+    stampSnapshot(&cam, win->scene, snap, 0, 0, &visits, color, (int)(size * win->renderScale));
+    markSceneDirty(win);
+}
@@ -0,0 +1,64 @@
+#ifndef SNAPSHOT_H
+#define SNAPSHOT_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#include "quadtree.h"
+
+/*
+ * Flat, pointer-free image of a built QuadTree:
+ *
+ *   QuadSnapshotHeader | QuadSnapshotNode[nodeCount] | vec2[pointCount]
+ *
+ * Children of a node are stored as four consecutive nodes (NW, NE, SW, SE) starting
+ * at firstChild, and points are laid out in depth-first order so the points of any
+ * subtree are contiguous. Fields are in host byte order; a byte-swapped magic means
+ * the file came from a machine of the other endianness and is rejected.
+ */
+#define QUAD_SNAPSHOT_MAGIC   0x54514443u  // "CDQT"
+#define QUAD_SNAPSHOT_VERSION 1
+
+typedef struct QuadSnapshotHeader
+{
+    uint32_t magic;
+    uint32_t version;
+    uint32_t nodeCount;
+    uint32_t pointCount;
+    uint32_t nodeCapacity;    // QUAD_NODE_CAPACITY of the tree that was saved
+    uint32_t reserved;
+    uint64_t nodesOffset;     // byte offsets from the start of the file
+    uint64_t pointsOffset;
+} QuadSnapshotHeader;
+
+typedef struct QuadSnapshotNode
+{
+    AABB boundary;
+    uint32_t firstChild;      // 0 for leaves; the root is never anyone's child
+    uint32_t firstPoint;
+    uint32_t pointCount;      // points stored in this leaf
+    uint32_t subtreeCount;    // points in the whole subtree, starting at firstPoint
+} QuadSnapshotNode;
+
+typedef struct QuadSnapshot
+{
+    void* map;
+    size_t size;
+    const QuadSnapshotHeader* header;
+    const QuadSnapshotNode* nodes;
+    const vec2* points;
+} QuadSnapshot;
+
+bool saveQuadTreeSnapshot(QuadTree* quad, const char* path);
+
+// Maps the file read-only; nothing is parsed or copied beyond validating the header.
+// Node indices are bounds-checked during each walk and a corrupt node is treated as empty.
+QuadSnapshot* openQuadSnapshot(const char* path);
+void closeQuadSnapshot(QuadSnapshot* snap);
+
+int querySnapshotRange(const QuadSnapshot* snap, AABB range, vec2* found, int maxFound);
+void drawSnapshot(VWindow* win, const QuadSnapshot* snap);
+void drawSnapshotPoints(VWindow* win, const QuadSnapshot* snap, unsigned int color, int size);
+
+#endif //SNAPSHOT_H
@@ -0,0 +1,91 @@
+#include "spatial.h"
+
+SpatialIndex* spatialCreate(const SpatialIndexOps* ops, AABB bounds)
+{
+    SpatialIndex* index = ops->create(bounds);
+    if (index) {
+        index->ops = ops;
+        index->bounds = bounds;
+    }
+    return index;
+}
+
+void spatialDestroy(SpatialIndex* index)
+{
+    if (index) index->ops->destroy(index);
+}
+
+bool spatialInsert(SpatialIndex* index, vec2 p)
+{
+    return index->ops->insert(index, p);
+}
+
+void spatialBuild(SpatialIndex* index, const vec2* points, int count)
+{
+    index->ops->build(index, points, count);
+}
+
+int spatialQueryRange(SpatialIndex* index, AABB range, vec2* found, int maxFound)
+{
+    return index->ops->queryRange(index, range, found, maxFound);
+}
+
+bool spatialNearest(SpatialIndex* index, vec2 target, vec2* nearest)
+{
+    return index->ops->nearest(index, target, nearest);
+}
+
+// Quadtree backend: a thin wrapper, the tree itself lives in quadtree.c
+typedef struct QuadTreeIndex
+{
+    SpatialIndex base;
+    QuadTree* root;
+} QuadTreeIndex;
+
+static SpatialIndex* quadTreeIndexCreate(AABB bounds)
+{
+    QuadTreeIndex* index = (QuadTreeIndex*)malloc(sizeof(QuadTreeIndex));
+    if (!index) return NULL;
+    index->root = constructQuadTree(bounds.center, bounds.halfWidth, bounds.halfHeight);
+    return &index->base;
+}
+
+static void quadTreeIndexDestroy(SpatialIndex* base)
+{
+    QuadTreeIndex* index = (QuadTreeIndex*)base;
+    freeQuadTree(index->root);
+    free(index);
+}
+
+static bool quadTreeIndexInsert(SpatialIndex* base, vec2 p)
+{
+    return insert(((QuadTreeIndex*)base)->root, p);
+}
+
+static void quadTreeIndexBuild(SpatialIndex* base, const vec2* points, int count)
+{
+    QuadTree* root = ((QuadTreeIndex*)base)->root;
+    for (int i = 0; i < count; i++) {
+        insert(root, points[i]);
+    }
+}
+
+static int quadTreeIndexQueryRange(SpatialIndex* base, AABB range, vec2* found, int maxFound)
+{
+    return queryRange(((QuadTreeIndex*)base)->root, range, found, maxFound);
+}
+
+static bool quadTreeIndexNearest(SpatialIndex* base, vec2 target, vec2* nearest)
+{
+    return nearestPoint(((QuadTreeIndex*)base)->root, target, nearest);
+}
+
+const SpatialIndexOps quadTreeIndexOps = {
+    "quadtree",
+    quadTreeIndexCreate,
+    quadTreeIndexDestroy,
+    quadTreeIndexInsert,
+    quadTreeIndexBuild,
+    quadTreeIndexQueryRange,
+    quadTreeIndexNearest,
+};
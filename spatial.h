@@ -0,0 +1,46 @@
+#ifndef SPATIAL_H
+#define SPATIAL_H
+
+#include <stdbool.h>
+
+#include "quadtree.h"
+#include "vec2.h"
+
+/*
+ * Common interface over the point indices. Each backend embeds SpatialIndex as
+ * its first member and fills in a SpatialIndexOps table; callers only go
+ * through the spatial* wrappers below.
+ *
+ * Points outside the bounds given at creation are rejected by insert and skipped by build.
+ */
+typedef struct SpatialIndex SpatialIndex;
+
+typedef struct SpatialIndexOps
+{
+    const char* name;
+    SpatialIndex* (*create)(AABB bounds);
+    void (*destroy)(SpatialIndex* index);
+    bool (*insert)(SpatialIndex* index, vec2 p);
+    void (*build)(SpatialIndex* index, const vec2* points, int count);  // adds all points at once
+    int (*queryRange)(SpatialIndex* index, AABB range, vec2* found, int maxFound);
+    bool (*nearest)(SpatialIndex* index, vec2 target, vec2* nearest);
+} SpatialIndexOps;
+
+struct SpatialIndex
+{
+    const SpatialIndexOps* ops;
+    AABB bounds;
+};
+
+extern const SpatialIndexOps gridIndexOps;      // grid.c
+extern const SpatialIndexOps kdTreeIndexOps;    // kdtree.c
+extern const SpatialIndexOps quadTreeIndexOps;  // spatial.c, wraps QuadTree
+
+SpatialIndex* spatialCreate(const SpatialIndexOps* ops, AABB bounds);
+void spatialDestroy(SpatialIndex* index);
+bool spatialInsert(SpatialIndex* index, vec2 p);
+void spatialBuild(SpatialIndex* index, const vec2* points, int count);
+int spatialQueryRange(SpatialIndex* index, AABB range, vec2* found, int maxFound);
+bool spatialNearest(SpatialIndex* index, vec2 target, vec2* nearest);
+
+#endif //SPATIAL_H
@@ -0,0 +1,181 @@
+#include <time.h>
+#include <string.h>
+#include <math.h>
+#include "random.h"
+#include "spatial.h"
+#include "define.h"
+
+// Compares the spatial index backends on the point distributions cdraw generates
+// and reports the fastest one for each distribution and point count.
+//
+// Usage: spatialbench [maxPoints]
+
+#define WORLD_SIZE 1200.0f
+#define BENCH_SEED 12345
+#define BENCH_QUERIES 2000
+#define BENCH_RANGE_TARGET 32  // points an average range query returns on uniform data
+#define DEFAULT_MAX_POINTS 1000000
+#define BENCH_RUNS 5            // timed runs per backend after one warm-up run; the median is reported
+
+typedef enum Distribution
+{
+    DIST_UNIFORM,
+    DIST_CLUSTERED,         // what main.c draws: x^0.5, y^1
+    DIST_HEAVY_CLUSTERED,   // x^4, y^4, piled into one corner
+    DIST_GAUSSIAN,
+    DIST_COUNT
+} Distribution;
+
+static const char* distributionNames[DIST_COUNT] = {"uniform", "clustered", "clustered^4", "gaussian"};
+
+static const SpatialIndexOps* backends[] = {&gridIndexOps, &kdTreeIndexOps, &quadTreeIndexOps};
+#define BACKEND_COUNT ((int)(sizeof(backends) / sizeof(backends[0])))
+
+static double nowMs(void)
+{
+    struct timespec t;
+    clock_gettime(CLOCK_MONOTONIC, &t);
+    return t.tv_sec * 1000.0 + t.tv_nsec / 1e6;
+}
+
+static void generate(Distribution dist, vec2* out, int count)
+{
+    switch (dist) {
+        case DIST_UNIFORM:        randUniform(out, count, WORLD_SIZE, WORLD_SIZE); break;
+        case DIST_CLUSTERED:      randClustered(out, count, WORLD_SIZE, WORLD_SIZE, 0.5f, 1.0f); break;
+        case DIST_HEAVY_CLUSTERED: randClustered(out, count, WORLD_SIZE, WORLD_SIZE, 4.0f, 4.0f); break;
+        case DIST_GAUSSIAN:       randGaussianClusters(out, count, WORLD_SIZE, WORLD_SIZE, 16, WORLD_SIZE * 0.01f); break;
+        default: break;
+    }
+}
+
+typedef struct BenchResult
+{
+    double buildMs;
+    double rangeMs;
+    double nearestMs;
+    long rangeHits;         // must agree across backends
+    double nearestDistance; // sum of nearest distances, must agree too
+} BenchResult;
+
+static BenchResult runBackend(const SpatialIndexOps* ops, AABB bounds, const vec2* points, int count,
+                              const AABB* ranges, const vec2* targets, vec2* found, int maxFound)
+{
+    BenchResult result = {0};
+
+    double start = nowMs();
+    SpatialIndex* index = spatialCreate(ops, bounds);
+    ASSERT(index != NULL);
+    spatialBuild(index, points, count);
+    result.buildMs = nowMs() - start;
+
+    start = nowMs();
+    for (int q = 0; q < BENCH_QUERIES; q++) {
+        result.rangeHits += spatialQueryRange(index, ranges[q], found, maxFound);
+    }
+    result.rangeMs = nowMs() - start;
+
+    start = nowMs();
+    for (int q = 0; q < BENCH_QUERIES; q++) {
+        vec2 nearest;
+        if (spatialNearest(index, targets[q], &nearest)) {
+            float dx = nearest.x - targets[q].x, dy = nearest.y - targets[q].y;
+            result.nearestDistance += sqrtf(dx * dx + dy * dy);
+        }
+    }
+    result.nearestMs = nowMs() - start;
+
+    spatialDestroy(index);
+    return result;
+}
+
+static int compareDouble(const void* a, const void* b)
+{
+    double x = *(const double*)a, y = *(const double*)b;
+    return (x > y) - (x < y);
+}
+
+static double medianMs(double* ms, int count)
+{
+    qsort(ms, count, sizeof(double), compareDouble);
+    return ms[count / 2];
+}
+
+// Warm-up first so allocator state left by the previous backend or size does not land in the timings
+static BenchResult benchBackend(const SpatialIndexOps* ops, AABB bounds, const vec2* points, int count,
+                                const AABB* ranges, const vec2* targets, vec2* found, int maxFound)
+{
+    BenchResult result = runBackend(ops, bounds, points, count, ranges, targets, found, maxFound);
+
+    double build[BENCH_RUNS], range[BENCH_RUNS], nearest[BENCH_RUNS];
+    for (int run = 0; run < BENCH_RUNS; run++) {
+        BenchResult r = runBackend(ops, bounds, points, count, ranges, targets, found, maxFound);
+        build[run] = r.buildMs;
+        range[run] = r.rangeMs;
+        nearest[run] = r.nearestMs;
+    }
+    result.buildMs = medianMs(build, BENCH_RUNS);
+    result.rangeMs = medianMs(range, BENCH_RUNS);
+    result.nearestMs = medianMs(nearest, BENCH_RUNS);
+    return result;
+}
+
+int main(int argc, char** argv)
+{
+    int maxPoints = argc > 1 ? atoi(argv[1]) : DEFAULT_MAX_POINTS;
+    if (maxPoints < 1) maxPoints = DEFAULT_MAX_POINTS;
+
+    vec2 center = {WORLD_SIZE / 2.0f, WORLD_SIZE / 2.0f};
+    AABB bounds = constructBoundingBox(center, WORLD_SIZE / 2.0f, WORLD_SIZE / 2.0f);
+
+    vec2* points = (vec2*)malloc(maxPoints * sizeof(vec2));
+    vec2* found = (vec2*)malloc(maxPoints * sizeof(vec2));
+    AABB* ranges = (AABB*)malloc(BENCH_QUERIES * sizeof(AABB));
+    vec2* targets = (vec2*)malloc(BENCH_QUERIES * sizeof(vec2));
+    ASSERT(points && found && ranges && targets);
+
+    printf("quadtree capacity %d, %d range + %d nearest queries per run, median of %d runs\n\n",
+           QUAD_NODE_CAPACITY, BENCH_QUERIES, BENCH_QUERIES, BENCH_RUNS);
+    printf("%-12s %9s  %-9s %10s %10s %10s %10s\n", "distribution", "points", "backend", "build ms", "range ms", "nearest ms", "total ms");
+
+    for (int dist = 0; dist < DIST_COUNT; dist++) {
+        for (int count = 1000; count <= maxPoints; count *= 10) {
+            rngSeed(BENCH_SEED);
+            generate((Distribution)dist, points, count);
+
+            // Range queries are centered on data points so clustered sets get queried where the points are
+            float half = 0.5f * WORLD_SIZE * sqrtf((float)BENCH_RANGE_TARGET / count);
+            for (int q = 0; q < BENCH_QUERIES; q++) {
+                ranges[q] = constructBoundingBox(points[rngNext(rngThread()) % count], half, half);
+            }
+            randUniform(targets, BENCH_QUERIES, WORLD_SIZE, WORLD_SIZE);
+
+            BenchResult results[BACKEND_COUNT];
+            int fastest = 0;
+            for (int b = 0; b < BACKEND_COUNT; b++) {
+                results[b] = benchBackend(backends[b], bounds, points, count, ranges, targets, found, maxPoints);
+                BenchResult* r = &results[b];
+                double total = r->buildMs + r->rangeMs + r->nearestMs;
+                printf("%-12s %9d  %-9s %10.2f %10.2f %10.2f %10.2f\n", distributionNames[dist], count,
+                       backends[b]->name, r->buildMs, r->rangeMs, r->nearestMs, total);
+
+                BenchResult* f = &results[fastest];
+                if (total < f->buildMs + f->rangeMs + f->nearestMs) fastest = b;
+
+                if (r->rangeHits != results[0].rangeHits ||
+                    fabs(r->nearestDistance - results[0].nearestDistance) > 1e-3 * (1.0 + results[0].nearestDistance)) {
+                    fprintf(stderr, "%s disagrees with %s on %s/%d\n", backends[b]->name, backends[0]->name,
+                            distributionNames[dist], count);
+                    return 1;
+                }
+            }
+            printf("%-12s %9d  fastest: %s\n\n", distributionNames[dist], count, backends[fastest]->name);
+        }
+    }
+
+    free(points);
+    free(found);
+    free(ranges);
+    free(targets);
+    return 0;
+}
@@ -1,49 +1,210 @@
 #include "surface.h"
+#include "memtrack.h"
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
 
 Surface* createSurface(int w, int h) 
 {
-    Surface* surface = (Surface*)malloc(sizeof(Surface));
+    Surface* surface = (Surface*)memAlloc(MEM_SURFACE, sizeof(Surface));
     if (!surface) return NULL;
     surface->width = w;
     surface->height = h;
-    surface->pixels = (unsigned int*)malloc(w * h * sizeof(unsigned int));
+    surface->pixels = (unsigned int*)memCalloc(MEM_SURFACE, (size_t)w * h, sizeof(unsigned int));
     if (!surface->pixels) { 
-        free(surface);
+        memFree(MEM_SURFACE, surface, sizeof(Surface));
         return NULL;
     }
-    memset(surface->pixels, 0, w * h * sizeof(unsigned int));
     return surface;
 }
 
 void setPixel(Surface* surface, int x, int y, unsigned int color, int thickness) {
-    for (int dy = -thickness / 2; dy <= thickness / 2; dy++) {
-        for (int dx = -thickness / 2; dx <= thickness / 2; dx++) {
-            int newX = x + dx;
-            int newY = y + dy;
-            
-            // Add bound check considering thickness
-            if (newX >= 0 && newX < surface->width && newY >= 0 && newY < surface->height) {
-                surface->pixels[newY * surface->width + newX] = color;
-            }
+    if (thickness <= 1) {
+        if (x >= 0 && x < surface->width && y >= 0 && y < surface->height) {
+            surface->pixels[y * surface->width + x] = color;
         }
+        return;
+    }
+
+    // A square of side 2 * (thickness / 2) + 1 centered on (x, y), filled as clipped spans
+    int half = thickness / 2;
+    fillRect(surface, x - half, y - half, 2 * half + 1, 2 * half + 1, color);
+}
+
+void fillSpan(Surface* surface, int y, int x0, int x1, unsigned int color)
+{
+    if (y < 0 || y >= surface->height) return;
+    if (x0 < 0) x0 = 0;
+    if (x1 > surface->width) x1 = surface->width;
+
+    unsigned int* dst = surface->pixels + y * surface->width;
+    int x = x0;
+#if defined(__SSE2__)
+    if (x1 - x0 >= 8) {
+        __m128i fill = _mm_set1_epi32((int)color);
+        for (; x + 4 <= x1; x += 4) {
+            _mm_storeu_si128((__m128i*)(dst + x), fill);
+        }
+    }
+#endif
+    for (; x < x1; x++) {
+        dst[x] = color;
+    }
+}
+
+// Straight-alpha src over dst with the source alpha scaled by coverage (0-255)
+static inline unsigned int blendCoverage(unsigned int dst, unsigned int src, unsigned int coverage)
+{
+    unsigned int a = ((src >> 24) * coverage + 127) / 255;
+    unsigned int da = dst >> 24;
+    if (a == 0) return dst;
+    // Over a transparent pixel keep the color and let the compositor apply the alpha
+    if (da == 0) return (src & 0x00FFFFFF) | (a << 24);
+
+    unsigned int out = (a + da * (255 - a) / 255) << 24;
+    for (int shift = 0; shift < 24; shift += 8) {
+        unsigned int s = (src >> shift) & 0xFF;
+        unsigned int d = (dst >> shift) & 0xFF;
+        out |= ((s * a + d * (255 - a) + 127) / 255) << shift;
+    }
+    return out;
+}
+
+void blendSpan(Surface* surface, int y, int x0, int x1, unsigned int color, unsigned int coverage)
+{
+    if (y < 0 || y >= surface->height || coverage == 0) return;
+    if (coverage >= 255 && (color >> 24) == 0xFF) {
+        fillSpan(surface, y, x0, x1, color);
+        return;
+    }
+    if (x0 < 0) x0 = 0;
+    if (x1 > surface->width) x1 = surface->width;
+
+    unsigned int* dst = surface->pixels + y * surface->width;
+    for (int x = x0; x < x1; x++) {
+        dst[x] = blendCoverage(dst[x], color, coverage);
     }
 }
 
 void clearSurface(Surface* surface, unsigned int color) 
 {
-    for (int y = 0; y < surface->height; y++) 
+    int count = surface->width * surface->height;
+    for (int i = 0; i < count; i++) 
     {
-        for (int x = 0; x < surface->width; x++) 
-        {
-            setPixel(surface, x, y, color, 0);
+        surface->pixels[i] = color;
+    }
+}
+
+void fillRect(Surface* surface, int x, int y, int w, int h, unsigned int color)
+{
+    int x0 = x < 0 ? 0 : x;
+    int y0 = y < 0 ? 0 : y;
+    int x1 = x + w > surface->width ? surface->width : x + w;
+    int y1 = y + h > surface->height ? surface->height : y + h;
+
+    for (int row = y0; row < y1; row++)
+    {
+        fillSpan(surface, row, x0, x1, color);
+    }
+}
+
+void strokeRect(Surface* surface, int x, int y, int w, int h, unsigned int color)
+{
+    if (w <= 0 || h <= 0) return;
+    fillRect(surface, x, y, w, 1, color);
+    fillRect(surface, x, y + h - 1, w, 1, color);
+    fillRect(surface, x, y + 1, 1, h - 2, color);
+    fillRect(surface, x + w - 1, y + 1, 1, h - 2, color);
+}
+
+// Source coordinates are 16.16 fixed point, sampled at pixel centers
+static void scaleRowNearest(const unsigned int* src, unsigned int* dst, int srcW, int dstW)
+{
+    int step = (int)(((int64_t)srcW << 16) / dstW);
+    int sx = step / 2;
+    for (int x = 0; x < dstW; x++, sx += step) {
+        dst[x] = src[sx >> 16];
+    }
+}
+
+// Weights are 7 bit so (b - a) * w stays within a signed 16 bit lane
+static void scaleRowBilinear(const unsigned int* top, const unsigned int* bottom, unsigned int* dst,
+                             int srcW, int dstW, int wy)
+{
+    int step = (int)(((int64_t)srcW << 16) / dstW);
+    int sx = step / 2 - 32768;
+#if defined(__SSE2__)
+    __m128i zero = _mm_setzero_si128();
+    __m128i weightY = _mm_set1_epi16((short)wy);
+#endif
+    for (int x = 0; x < dstW; x++, sx += step) {
+        int x0 = sx < 0 ? 0 : sx >> 16;
+        int wx = sx < 0 ? 0 : (sx & 0xFFFF) >> 9;
+        // Past the last center, lean fully on the last column instead of reading beyond it
+        if (x0 >= srcW - 1) {
+            x0 = srcW - 2;
+            wx = 128;
+        }
+#if defined(__SSE2__)
+        // Both horizontal neighbours of each row at once: lanes 0-3 left pixel, 4-7 right pixel
+        __m128i a = _mm_unpacklo_epi8(_mm_loadl_epi64((const __m128i*)(top + x0)), zero);
+        __m128i b = _mm_unpacklo_epi8(_mm_loadl_epi64((const __m128i*)(bottom + x0)), zero);
+        __m128i v = _mm_add_epi16(a, _mm_srai_epi16(_mm_mullo_epi16(_mm_sub_epi16(b, a), weightY), 7));
+        __m128i right = _mm_srli_si128(v, 8);
+        __m128i h = _mm_add_epi16(v, _mm_srai_epi16(_mm_mullo_epi16(_mm_sub_epi16(right, v), _mm_set1_epi16((short)wx)), 7));
+        dst[x] = (unsigned int)_mm_cvtsi128_si32(_mm_packus_epi16(h, h));
+#else
+        unsigned int out = 0;
+        for (int shift = 0; shift < 32; shift += 8) {
+            int p00 = (top[x0] >> shift) & 0xFF, p01 = (top[x0 + 1] >> shift) & 0xFF;
+            int p10 = (bottom[x0] >> shift) & 0xFF, p11 = (bottom[x0 + 1] >> shift) & 0xFF;
+            int left = p00 + (((p10 - p00) * wy) >> 7);
+            int right = p01 + (((p11 - p01) * wy) >> 7);
+            out |= (unsigned int)(left + (((right - left) * wx) >> 7)) << shift;
+        }
+        dst[x] = out;
+#endif
+    }
+}
+
+void scaleSurface(const Surface* src, Surface* dst, int y0, int y1, bool bilinear)
+{
+    if (y0 < 0) y0 = 0;
+    if (y1 > dst->height) y1 = dst->height;
+    if (src->width < 2 || src->height < 2) bilinear = false;
+
+    int step = (int)(((int64_t)src->height << 16) / dst->height);
+    for (int y = y0; y < y1; y++) {
+        unsigned int* row = dst->pixels + y * dst->width;
+
+        if (!bilinear) {
+            // Upscaling repeats source rows: copy the row just expanded instead of expanding it again
+            int sy = (y * step + step / 2) >> 16;
+            if (y > y0 && sy == (((y - 1) * step + step / 2) >> 16)) {
+                memcpy(row, row - dst->width, dst->width * sizeof(unsigned int));
+            } else {
+                scaleRowNearest(src->pixels + sy * src->width, row, src->width, dst->width);
+            }
+            continue;
+        }
+
+        int sy = y * step + step / 2 - 32768;
+        int srcY = sy < 0 ? 0 : sy >> 16;
+        int wy = sy < 0 ? 0 : (sy & 0xFFFF) >> 9;
+        if (srcY >= src->height - 1) {
+            srcY = src->height - 2;
+            wy = 128;
         }
+        const unsigned int* top = src->pixels + srcY * src->width;
+        scaleRowBilinear(top, top + src->width, row, src->width, dst->width, wy);
     }
 }
 
 void freeSurface(Surface* surface) 
 {
-    free(surface->pixels);
-    free(surface);
+    memFree(MEM_SURFACE, surface->pixels, (size_t)surface->width * surface->height * sizeof(unsigned int));
+    memFree(MEM_SURFACE, surface, sizeof(Surface));
 }
 
 XImage* surfaceToXImage(Display* display, Surface* surface)
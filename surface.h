@@ -7,6 +7,7 @@
 #include <string.h>  // For memset
 #include <stdio.h>
 #include <stdlib.h>
+#include <stdbool.h>
 #include <stdint.h>
 #include <string.h>
 
@@ -19,8 +20,17 @@ typedef struct Surface
 Surface* createSurface(int w, int h);
 void setPixel(Surface* surface, int x, int y, unsigned int color, int thickness);
 void clearSurface(Surface* surface, unsigned int color);
+// Spans cover [x0, x1) on row y and are clipped; coverage is 0-255 and scales the color's alpha
+void fillSpan(Surface* surface, int y, int x0, int x1, unsigned int color);
+void blendSpan(Surface* surface, int y, int x0, int x1, unsigned int color, unsigned int coverage);
+// Both clip against the surface; strokeRect outlines the w x h box starting at (x, y)
+void fillRect(Surface* surface, int x, int y, int w, int h, unsigned int color);
+void strokeRect(Surface* surface, int x, int y, int w, int h, unsigned int color);
+// Resamples all of src onto all of dst, writing only rows [y0, y1) of dst; bilinear needs src at least 2 x 2
+void scaleSurface(const Surface* src, Surface* dst, int y0, int y1, bool bilinear);
 void freeSurface(Surface* surface);
 
+// The image borrows the surface's pixels: clear its data pointer before XDestroyImage
 XImage* surfaceToXImage(Display* display, Surface* surface);
 
 #endif //SURFACE_H
\ No newline at end of file
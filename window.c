@@ -1,4 +1,5 @@
 #include "window.h"
+#include "memtrack.h"
 #include <stdarg.h>
 #include <stdio.h>
 #include <string.h>
@@ -9,8 +10,65 @@
 #include <stdlib.h>
 #include <string.h>
 
+// The XImage data is ours, so free it through the tracker before Xlib frees the rest
+static void destroyFrameImage(VWindow* win) {
+    memFree(MEM_WINDOW, win->ximage->data, (size_t)win->ximage->bytes_per_line * win->ximage->height);
+    win->ximage->data = NULL;
+    XDestroyImage(win->ximage);
+    win->ximage = NULL;
+}
+
+// Lets X rasterize the printable glyphs side by side once so drawing text never goes back to the server
+static void buildGlyphAtlas(VWindow* win) {
+    GlyphAtlas* atlas = &win->atlas;
+    XFontStruct* font = win->font;
+    atlas->ascent = font->max_bounds.ascent;
+    atlas->height = font->max_bounds.ascent + font->max_bounds.descent;
+    atlas->width = 0;
+    for (int i = 0; i < GLYPH_COUNT; i++) {
+        char c = (char)(GLYPH_FIRST + i);
+        int direction, ascent, descent;
+        XCharStruct extents;
+        XTextExtents(font, &c, 1, &direction, &ascent, &descent, &extents);
+        Glyph* glyph = &atlas->glyphs[i];
+        glyph->x = atlas->width;
+        glyph->lbearing = extents.lbearing;
+        glyph->width = extents.rbearing > extents.lbearing ? extents.rbearing - extents.lbearing : 0;
+        glyph->advance = extents.width;
+        atlas->width += glyph->width;
+    }
+    if (atlas->width <= 0 || atlas->height <= 0) return;
+
+    Pixmap scratch = XCreatePixmap(win->display, win->window, atlas->width, atlas->height,
+                                   DefaultDepth(win->display, win->screen));
+    XSetForeground(win->display, win->gc, BlackPixel(win->display, win->screen));
+    XFillRectangle(win->display, scratch, win->gc, 0, 0, atlas->width, atlas->height);
+    XSetForeground(win->display, win->gc, WhitePixel(win->display, win->screen));
+    for (int i = 0; i < GLYPH_COUNT; i++) {
+        char c = (char)(GLYPH_FIRST + i);
+        const Glyph* glyph = &atlas->glyphs[i];
+        XDrawString(win->display, scratch, win->gc, glyph->x - glyph->lbearing, atlas->ascent, &c, 1);
+    }
+
+    XImage* image = XGetImage(win->display, scratch, 0, 0, atlas->width, atlas->height, AllPlanes, ZPixmap);
+    if (image) {
+        atlas->coverage = memAlloc(MEM_WINDOW, (size_t)atlas->width * atlas->height);
+        if (atlas->coverage) {
+            for (int y = 0; y < atlas->height; y++) {
+                for (int x = 0; x < atlas->width; x++) {
+                    atlas->coverage[y * atlas->width + x] = (unsigned char)(XGetPixel(image, x, y) & 0xFF);
+                }
+            }
+        } else {
+            fprintf(stderr, "Failed to allocate the glyph atlas\n");
+        }
+        XDestroyImage(image);
+    }
+    XFreePixmap(win->display, scratch);
+}
+
 VWindow* createWindow(int w, int h) {
-    VWindow* win = (VWindow*)malloc(sizeof(VWindow));
+    VWindow* win = (VWindow*)memAlloc(MEM_WINDOW, sizeof(VWindow));
     if (!win) {
         fprintf(stderr, "Failed to allocate memory for VWindow\n");
         return NULL;
@@ -20,14 +78,17 @@ VWindow* createWindow(int w, int h) {
     win->display = NULL;
     win->gc = NULL;
     win->surface = NULL;
+    win->scene = NULL;
+    for (int i = 0; i < LAYER_COUNT; i++) win->layers[i].surface = NULL;
     win->ximage = NULL;
     win->font = NULL;
+    win->atlas.coverage = NULL;
     win->backBuffer = None;
     
     win->display = XOpenDisplay(NULL);
     if (win->display == NULL) {
         fprintf(stderr, "Cannot open display\n");
-        free(win);
+        memFree(MEM_WINDOW, win, sizeof(VWindow));
         return NULL;
     }
 
@@ -37,18 +98,29 @@ VWindow* createWindow(int w, int h) {
                                       BlackPixel(win->display, win->screen), 
                                       WhitePixel(win->display, win->screen));
 
-    XSelectInput(win->display, win->window, ExposureMask | KeyPressMask);
+    XSelectInput(win->display, win->window, ExposureMask | KeyPressMask |
+                 ButtonPressMask | ButtonReleaseMask | Button1MotionMask);
     XMapWindow(win->display, win->window);
 
     win->gc = XCreateGC(win->display, win->window, 0, NULL);
-    win->surface = createSurface(w, h);
+    bool layersOk = true;
+    for (int i = 0; i < LAYER_COUNT; i++) {
+        layersOk = initLayer(&win->layers[i], w, h, true) && layersOk;
+    }
+    win->surface = win->layers[LAYER_POINTS].surface;
+    win->scene = win->surface;
+    win->renderScale = 1.0f;
+    win->sceneScaled = false;
+    win->bilinear = false;
+    win->adaptiveResolution = true;
     
-    if (!win->surface) {
+    if (!layersOk) {
         fprintf(stderr, "Failed to create surface\n");
+        for (int i = 0; i < LAYER_COUNT; i++) freeLayer(&win->layers[i]);
         XFreeGC(win->display, win->gc);
         XDestroyWindow(win->display, win->window);
         XCloseDisplay(win->display);
-        free(win);
+        memFree(MEM_WINDOW, win, sizeof(VWindow));
         return NULL;
     }
 
@@ -56,11 +128,10 @@ VWindow* createWindow(int w, int h) {
                            24, ZPixmap, 0, NULL, w, h, 32, 0); 
 
     if (win->ximage) {
-        win->ximage->data = malloc(win->ximage->bytes_per_line * h);
+        win->ximage->data = memAlloc(MEM_WINDOW, (size_t)win->ximage->bytes_per_line * h);
         if (!win->ximage->data) {
             fprintf(stderr, "Failed to allocate memory for XImage data\n");
-            XDestroyImage(win->ximage);
-            win->ximage = NULL;
+            destroyFrameImage(win);
         }
     }
 
@@ -68,11 +139,14 @@ VWindow* createWindow(int w, int h) {
     // Create a larger font
     XFontStruct *font = XLoadQueryFont(win->display, "-*-helvetica-bold-r-*-*-18-*-*-*-*-*-*-*");
     if (font == NULL) {
-        fprintf(stderr, "Failed to load font\n");
-        // Handle error (use a default font or exit)
-    } else {
+        fprintf(stderr, "Failed to load font, falling back to fixed\n");
+        font = XLoadQueryFont(win->display, "fixed");
+    }
+    win->font = font;
+    if (font != NULL) {
         // Set the font in the GC
         XSetFont(win->display, win->gc, font->fid);
+        buildGlyphAtlas(win);
     }
 
      // Create back buffer
@@ -83,6 +157,14 @@ VWindow* createWindow(int w, int h) {
         // Clean up and return NULL
     }
 
+    win->width = w;
+    win->height = h;
+
+    vec2 viewCenter = {w / 2.0f, h / 2.0f};
+    initCamera(&win->camera, viewCenter, 1.0f, w, h);
+    win->viewChanged = true;
+    win->dragging = false;
+
     win->drawQuads = true;
     win->randomize = false;
 
@@ -106,8 +188,7 @@ void destroyWindow(VWindow* win) {
             }
             if (win->ximage) {
                 printf("Destroying XImage\n");
-                XDestroyImage(win->ximage);
-                win->ximage = NULL;
+                destroyFrameImage(win);
             }
             if (win->backBuffer) {
                 printf("Freeing Pixmap\n");
@@ -124,6 +205,10 @@ void destroyWindow(VWindow* win) {
                 XFreeFont(win->display, win->font);
                 win->font = NULL;
             }
+            if (win->atlas.coverage) {
+                memFree(MEM_WINDOW, win->atlas.coverage, (size_t)win->atlas.width * win->atlas.height);
+                win->atlas.coverage = NULL;
+            }
             
             printf("Syncing display\n");
             XSync(win->display, True);
@@ -132,13 +217,17 @@ void destroyWindow(VWindow* win) {
             XCloseDisplay(win->display);
             win->display = NULL;
         }
-        if (win->surface) {
-            printf("Freeing Surface\n");
-            freeSurface(win->surface);
-            win->surface = NULL;
+        if (win->scene != win->surface) {
+            freeSurface(win->scene);
+        }
+        win->scene = NULL;
+        printf("Freeing Layers\n");
+        for (int i = 0; i < LAYER_COUNT; i++) {
+            freeLayer(&win->layers[i]);
         }
+        win->surface = NULL;
         printf("Freeing window struct\n");
-        free(win);
+        memFree(MEM_WINDOW, win, sizeof(VWindow));
     }
     printf("Exiting destroyWindow\n");
 }
@@ -150,7 +239,7 @@ void handleEvents(VWindow* win) {
         switch (event.type) {
             case Expose:
                 printf("Expose event\n");
-                drawSurfaceToWindow(win);
+                presentWindow(win);
                 break;
             case KeyPress:
                 {
@@ -158,16 +247,76 @@ void handleEvents(VWindow* win) {
                     if (key == XK_space) {
                         printf("Space key pressed\n");
                         win->drawQuads = !win->drawQuads;
-                        drawSurfaceToWindow(win);
+                        setLayerVisible(&win->layers[LAYER_QUADS], win->drawQuads);
                     } else if (key == XK_Escape) {
                         printf("Escape key pressed\n");
                         win->shouldClose = true;
                     } else if (key == XK_r) {
                         printf("R key pressed\n");
                         win->randomize = true;
+                    } else if (key == XK_Left || key == XK_a) {
+                        panCamera(&win->camera, CAMERA_PAN_STEP, 0);
+                        win->viewChanged = true;
+                    } else if (key == XK_Right || key == XK_d) {
+                        panCamera(&win->camera, -CAMERA_PAN_STEP, 0);
+                        win->viewChanged = true;
+                    } else if (key == XK_Up || key == XK_w) {
+                        panCamera(&win->camera, 0, CAMERA_PAN_STEP);
+                        win->viewChanged = true;
+                    } else if (key == XK_Down || key == XK_s) {
+                        panCamera(&win->camera, 0, -CAMERA_PAN_STEP);
+                        win->viewChanged = true;
+                    } else if (key == XK_plus || key == XK_equal || key == XK_KP_Add) {
+                        vec2 center = {win->camera.viewWidth / 2.0f, win->camera.viewHeight / 2.0f};
+                        zoomCamera(&win->camera, CAMERA_ZOOM_STEP, center);
+                        win->viewChanged = true;
+                    } else if (key == XK_minus || key == XK_KP_Subtract) {
+                        vec2 center = {win->camera.viewWidth / 2.0f, win->camera.viewHeight / 2.0f};
+                        zoomCamera(&win->camera, 1.0f / CAMERA_ZOOM_STEP, center);
+                        win->viewChanged = true;
+                    } else if (key == XK_x) {
+                        win->adaptiveResolution = !win->adaptiveResolution;
+                        printf("Adaptive resolution %s\n", win->adaptiveResolution ? "on" : "off");
+                    } else if (key == XK_b) {
+                        win->bilinear = !win->bilinear;
+                        win->viewChanged = true;
+                    } else if (key == XK_Home || key == XK_0) {
+                        vec2 center = {win->width / 2.0f, win->height / 2.0f};
+                        initCamera(&win->camera, center, 1.0f, win->width, win->height);
+                        win->viewChanged = true;
                     }
                 }
                 break;
+            case ButtonPress:
+                {
+                    vec2 cursor = {(float)event.xbutton.x, (float)event.xbutton.y};
+                    if (event.xbutton.button == Button1) {
+                        win->dragging = true;
+                        win->dragX = event.xbutton.x;
+                        win->dragY = event.xbutton.y;
+                    } else if (event.xbutton.button == Button4) {
+                        zoomCamera(&win->camera, CAMERA_ZOOM_STEP, cursor);
+                        win->viewChanged = true;
+                    } else if (event.xbutton.button == Button5) {
+                        zoomCamera(&win->camera, 1.0f / CAMERA_ZOOM_STEP, cursor);
+                        win->viewChanged = true;
+                    }
+                }
+                break;
+            case ButtonRelease:
+                if (event.xbutton.button == Button1) {
+                    win->dragging = false;
+                }
+                break;
+            case MotionNotify:
+                if (win->dragging) {
+                    panCamera(&win->camera, (float)(event.xmotion.x - win->dragX),
+                                            (float)(event.xmotion.y - win->dragY));
+                    win->dragX = event.xmotion.x;
+                    win->dragY = event.xmotion.y;
+                    win->viewChanged = true;
+                }
+                break;
             case ClientMessage:
                 if ((Atom)event.xclient.data.l[0] == win->wmDeleteMessage) {
                     printf("Window close button clicked\n");
@@ -182,12 +331,14 @@ void handleEvents(VWindow* win) {
 void clearColor(VWindow* window, unsigned int color)
 {
     clearSurface(window->surface, color);
+    markLayerAllDirty(&window->layers[LAYER_POINTS]);
     drawSurfaceToWindow(window);
 }
 
 void drawPoint(VWindow* window, int x, int y, unsigned int color, int size)
 {
     setPixel(window->surface, x, y, color, size);
+    markLayerDirty(&window->layers[LAYER_POINTS], y - size / 2, y + size / 2 + 1);
     drawSurfaceToWindow(window);
 }
 
@@ -199,30 +350,107 @@ void presentWindow(VWindow* window)
     XFlush(window->display);
 }
 
+bool setRenderScale(VWindow* window, float scale)
+{
+    int w = (int)(window->width * scale + 0.5f);
+    int h = (int)(window->height * scale + 0.5f);
+    if (w < 1) w = 1;
+    if (h < 1) h = 1;
+    if (w == window->scene->width && h == window->scene->height) return true;
+
+    if (window->scene != window->surface) {
+        freeSurface(window->scene);
+    }
+    window->scene = window->surface;
+    window->renderScale = 1.0f;
+    window->sceneScaled = false;
+    if (w >= window->width && h >= window->height) return true;
+
+    Surface* scene = createSurface(w, h);
+    if (!scene) {
+        fprintf(stderr, "Failed to create %dx%d scene, staying at full resolution\n", w, h);
+        return false;
+    }
+    window->scene = scene;
+    window->renderScale = (float)w / window->width;
+    return true;
+}
+
+Camera sceneCamera(const VWindow* window)
+{
+    return resizeCameraView(&window->camera, window->scene->width, window->scene->height);
+}
+
+void markSceneDirty(VWindow* window)
+{
+    markLayerAllDirty(&window->layers[LAYER_POINTS]);
+    window->sceneScaled = window->scene != window->surface;
+}
+
 void drawSurfaceToWindow(VWindow* window)
 {
     if (!window || !window->display || !window->window || !window->gc || !window->ximage || !window->surface || !window->backBuffer) {
         fprintf(stderr, "Error: Invalid WindowWrapper state in drawSurfaceToWindow\n");
         return;
     }
-    // Copy surface data to XImage
-    window->ximage = surfaceToXImage(window->display, window->surface);
-    //memcpy(window->ximage->data, window->surface->pixels, window->surface->width * window->surface->height * sizeof(unsigned int));
+
+    // Bring a reduced resolution scene up to window size
+    if (window->sceneScaled) {
+        scaleSurface(window->scene, window->surface, 0, window->surface->height, window->bilinear);
+        window->sceneScaled = false;
+    }
+
+    int y0, y1;
+    if (!layersDirtyRows(window->layers, LAYER_COUNT, &y0, &y1)) return;
+
+    // Composite only the changed rows into the XImage
+    compositeLayers(window->layers, LAYER_COUNT, (unsigned int*)window->ximage->data,
+                    window->ximage->bytes_per_line / sizeof(unsigned int), y0, y1);
 
     // Draw to back buffer
-    XPutImage(window->display, window->backBuffer, window->gc, window->ximage, 0, 0, 0, 0, 
-              window->surface->width, window->surface->height);
+    XPutImage(window->display, window->backBuffer, window->gc, window->ximage, 0, y0, 0, y0, 
+              window->surface->width, y1 - y0);
 
     // Copy back buffer to window
     XCopyArea(window->display, window->backBuffer, window->window, window->gc, 
-              0, 0, window->surface->width, window->surface->height, 0, 0);
+              0, y0, window->surface->width, y1 - y0, 0, y0);
 
     XFlush(window->display);
 }
 
-// Existing function, modified to use the new abstractions
 void drawText(VWindow* window, int x, int y, const char* text, unsigned int color, int fontSize)
 {
-    XSetForeground(window->display, window->gc, color);
-    XDrawString(window->display, window->backBuffer, window->gc, x, y, text, strlen(text));
+    const GlyphAtlas* atlas = &window->atlas;
+    if (!atlas->coverage) return;
+
+    // Blend each glyph's coverage out of the atlas so text edges mix with whatever the HUD already holds
+    Surface* hud = window->layers[LAYER_HUD].surface;
+    int top = y - atlas->ascent;
+    int pen = x;
+    for (const char* c = text; *c; c++) {
+        int index = (unsigned char)*c - GLYPH_FIRST;
+        if (index < 0 || index >= GLYPH_COUNT) index = 0;
+        const Glyph* glyph = &atlas->glyphs[index];
+        for (int gy = 0; gy < atlas->height; gy++) {
+            const unsigned char* row = atlas->coverage + gy * atlas->width + glyph->x;
+            for (int gx = 0; gx < glyph->width; gx++) {
+                int px = pen + glyph->lbearing + gx;
+                blendSpan(hud, top + gy, px, px + 1, color, row[gx]);
+            }
+        }
+        pen += glyph->advance;
+    }
+    markLayerDirty(&window->layers[LAYER_HUD], top, top + atlas->height);
+}
+
+int textWidth(const VWindow* window, const char* text)
+{
+    if (!window->atlas.coverage) return 0;
+    int width = 0;
+    for (const char* c = text; *c; c++) {
+        int index = (unsigned char)*c - GLYPH_FIRST;
+        if (index < 0 || index >= GLYPH_COUNT) index = 0;
+        width += window->atlas.glyphs[index].advance;
+    }
+    return width;
 }
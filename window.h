@@ -4,19 +4,62 @@
 #include "vec2.h"
 #include <stdbool.h>
 #include "surface.h"
+#include "camera.h"
+#include "layer.h"
 #include <X11/Xlib.h>
 
+// Composited bottom to top
+enum
+{
+    LAYER_POINTS,   // opaque base
+    LAYER_QUADS,    // quadtree outlines, transparent elsewhere
+    LAYER_HUD,      // text
+    LAYER_COUNT
+};
+
+#define GLYPH_FIRST 32      // printable ASCII, rasterized once into the glyph atlas
+#define GLYPH_COUNT 95
+
+typedef struct Glyph
+{
+    int x;          // left edge of the glyph's ink in the atlas
+    int lbearing;   // ink offset from the pen position
+    int width;      // ink width
+    int advance;
+} Glyph;
+
+// Coverage of every printable glyph, one byte per pixel, all sharing the font's baseline
+typedef struct GlyphAtlas
+{
+    unsigned char* coverage;
+    int width;
+    int height;
+    int ascent;     // baseline row
+    Glyph glyphs[GLYPH_COUNT];
+} GlyphAtlas;
+
 typedef struct VVWindow {
     Display* display;
     Window window; 
     GC gc;
-    Surface* surface;
-    XImage* ximage;
+    Layer layers[LAYER_COUNT];
+    Surface* surface;       // base layer, same as layers[LAYER_POINTS].surface
+    Surface* scene;         // where the points are rasterized: the base layer, or a smaller surface below full resolution
+    float renderScale;      // scene size relative to the window
+    bool sceneScaled;       // scene was redrawn below full resolution and is upscaled into the base layer at present
+    bool bilinear;          // upscale filter, nearest otherwise
+    bool adaptiveResolution;
+    XImage* ximage;         // composited frame
     XFontStruct* font;
+    GlyphAtlas atlas;
     Pixmap backBuffer;
     XID screen;
     int width;
     int height;
+    Camera camera;
+    bool viewChanged;       // camera moved since the app last cleared this
+    bool dragging;
+    int dragX, dragY;
     bool drawQuads;
     bool randomize;
     bool shouldClose;  
@@ -26,13 +69,24 @@ typedef struct VVWindow {
 VWindow* createWindow(int w, int h);
 
 void destroyWindow(VWindow* win);
+// Composites the rows of any dirty layers and presents them; does nothing when no layer changed
 void drawSurfaceToWindow(VWindow* win);
 void handleEvents(VWindow* win);
+// Renders text into the HUD layer with its baseline at y
 void drawText(VWindow *win, int x, int y, const char *text, unsigned int color, int textSize);
+// Advance of the text as drawText lays it out
+int textWidth(const VWindow* win, const char* text);
 
 void clearColor(VWindow* window, unsigned int color);
 void drawPoint(VWindow* window, int x, int y, unsigned int color, int size);
 void presentWindow(VWindow* window);
 
+// Reallocates the scene at scale times the window size; on failure the scene stays at full resolution
+bool setRenderScale(VWindow* window, float scale);
+// The window's camera fitted to the scene
+Camera sceneCamera(const VWindow* window);
+// Call after redrawing the scene; while scaled the base layer is overwritten by the upscaled scene
+void markSceneDirty(VWindow* window);
+
 
 #endif //Window_H
\ No newline at end of file